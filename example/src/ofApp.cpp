@@ -15,11 +15,6 @@ float Bounce(float delay) {
   return 0.5f*(1.0 + glm::sin(Tick(delay) * glm::two_pi<float>()));
 }
 
-/* Noise function used by the gradient scaling. */
-float Noise(const ofPoint &vertex) {
-  return 24.0f * ofNoise(0.005f*vertex + 0.5f*ofGetElapsedTimeMillis()*0.0002f);
-}
-
 static constexpr int32_t kCharsetSize = 26;
 
 }  // namespace
@@ -31,11 +26,14 @@ void ofApp::setup()
   ofSetFrameRate(60);
 
   const float fontsize = 0.75f * ofGetHeight();
-  fontsampler_.setup("FreeSans.ttf", fontsize);
+  // The file is read and the default characters preloaded in the background,
+  // the demos starting once it is done.
+  fontsampler_.setupAsync("FreeSans.ttf", fontsize);
 
   start_letter_ = u'A';
   letter_index_ = 0;
   bPause_ = false;
+  bLODsReady_ = false;
   demo_index_ = 0;
 
   fontrenderer_ = new ofxFontRenderer(fontsampler_); //
@@ -43,14 +41,32 @@ void ofApp::setup()
 
 void ofApp::update()
 {
+  // get() would wait for the file to be read.
+  if (fontsampler_.isLoading()) {
+    return;
+  }
+
+  // Cache the samplings used by the first demo once the glyphes are loaded,
+  // so they are never recomputed.
+  if (!bLODsReady_) {
+    for (int32_t i = 0; i < kCharsetSize; ++i) {
+      if (auto *glyph = fontsampler_.get(start_letter_ + i); glyph) {
+        glyph->setupSamplingLODs({5, 6, 7, 8, 9, 10}, true);
+      }
+    }
+    bLODsReady_ = true;
+  }
   const float dx = ofMap(ofGetMouseX(), 0, ofGetWidth(), 0.01f, 1.0f);
   const float dy = ofMap(ofGetMouseY(), 0, ofGetHeight(), 0.2f, 1.0f);
 
-  // Functor used to change the glyph vertices along its normals as we sample it.
-  ofxGlyph::updateVertexFunc_t updateVertex = [dy](glm::vec3 &v, int id, const glm::vec3 &n) { 
-    const float scale = dy * Noise(dy * v);
-    v += scale * n; 
-  };
+  // Functor used to change the glyph vertices along its normals as we sample it,
+  // by a noise in [0, 24 * dy].
+  ofxGlyph::NoiseParams_t noise;
+  noise.amplitude = 12.0f * dy;
+  noise.bias      = 1.0f;
+  noise.frequency = 0.005f * dy;
+  noise.time      = 0.5f * ofGetElapsedTimeMillis() * 0.0002f;
+  const auto updateVertex = ofxGlyph::NoiseDisplacement(noise);
 
   // -----------------
 
@@ -86,7 +102,6 @@ void ofApp::update()
       polygon_.points, 
       polygon_.segments, 
       polygon_.holes, 
-      4,                                 // gradient step
       updateVertex
     );
     contour_.sampling = glyph_->outer_sampling_; //
@@ -104,7 +119,6 @@ void ofApp::update()
     glyph_->constructContourPolyline(
       128 + dx*256,                     // samples count (for the whole path)
       contour_.polyline, 
-      25.6f,                            // gradient step factor
       updateVertex    
     );
   } else {
@@ -117,6 +131,16 @@ void ofApp::update()
 
 void ofApp::draw()
 {
+  if (!bLODsReady_) {
+    ofBackground(50, 50, 50);
+    ofSetColor(255);
+    ofDrawBitmapString(
+      "loading " + ofToString(static_cast<int>(100.0f * fontsampler_.getLoadingProgress())) + "%",
+      20, 20
+    );
+    return;
+  }
+
   if (demo_index_ == 0) {
     // SAMPLE 1 : iterating over the 26 latin charset.
 
@@ -143,10 +167,14 @@ void ofApp::draw()
     // ofSetColor(50, 20, 25);
     // contour_.polyline.draw();  
 
+    // Fill, triangulated once per glyph instead of tessellating the path.
+    ofSetColor(190, 180, 122);
+    glyph_->getFillMesh(8).draw();
+
     // Path
+    path_.setFilled(false);
     path_.setStrokeWidth(3.0f);
     path_.setStrokeColor(ofColor(255, 155, 30));
-    path_.setFillColor(ofColor(190,180,122));
     path_.draw();
 
     // Voronoi.
@@ -162,8 +190,23 @@ void ofApp::draw()
 
     ofEnableDepthTest();
     
+    ofPushMatrix();
     ofRotateDeg( 35.0f, 0.0f, 1.0f, 0.0f);
     fontrenderer_->draw();
+    ofPopMatrix();
+
+    ofDisableDepthTest();
+    ofSetColor(255);
+    ofDrawBitmapString(
+      std::string(fontrenderer_->isFastTriangulation() ? "ear clipping" : "constrained delaunay")
+        + (fontrenderer_->isMergedGeometry() ? " (merged)" : "")
+        + " : " + ofToString(fontrenderer_->getUpdateTime()) + " ms"
+        + ", frame " + ofToString(1000.0 * ofGetLastFrameTime(), 2) + " ms"
+        + (fontrenderer_->isAsynchronous()
+            ? ", async latency " + ofToString(fontrenderer_->getAsyncStats().last_latency) + " ms"
+            : ""),
+      20, 20
+    );
   }
 }
 
@@ -181,6 +224,21 @@ void ofApp::keyPressed(int key)
   if (key == 'k') {
     letter_index_ = ofWrap(letter_index_-1, 0, kCharsetSize);
   }
+
+  // Toggle the text triangulation method for the second demo.
+  if (key == 't') {
+    fontrenderer_->setFastTriangulation(!fontrenderer_->isFastTriangulation());
+  }
+
+  // Toggle the single buffer text rendering for the second demo.
+  if (key == 'm') {
+    fontrenderer_->setMergedGeometry(!fontrenderer_->isMergedGeometry());
+  }
+
+  // Toggle the background generation of the text for the second demo.
+  if (key == 'a') {
+    fontrenderer_->setAsynchronous(!fontrenderer_->isAsynchronous());
+  }
 }
 
 void ofApp::mousePressed(int x, int y, int button)
@@ -22,6 +22,7 @@ class ofApp : public ofBaseApp {
   	uint16_t letter_index_;
 
   	bool bPause_;
+  	bool bLODsReady_;
     int32_t demo_index_;
 
   	// ----
@@ -0,0 +1,200 @@
+#include "curve_triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/* Twice the signed area of the triangle abc, positive when counterclockwise. */
+inline float Cross(const vertex_t &a, const vertex_t &b, const vertex_t &c) {
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+inline vertex_t Midpoint(const vertex_t &a, const vertex_t &b) {
+  return vertex_t(0.5f * (a.x + b.x), 0.5f * (a.y + b.y));
+}
+
+inline bool IsCurve(const GlyphPath::Segment_t &s) {
+  return Cross(s.p0, s.p1, s.p2) != 0.0f;
+}
+
+/* Check if the triangles of two segments overlap with the separating axis
+ * theorem, triangles only sharing an edge or a vertex do not. */
+bool Overlap(const GlyphPath::Segment_t &a, const GlyphPath::Segment_t &b) {
+  const vertex_t ta[3] = { a.p0, a.p1, a.p2 };
+  const vertex_t tb[3] = { b.p0, b.p1, b.p2 };
+
+  auto separated = [](const vertex_t *t, const vertex_t *u) {
+    for (int i = 0; i < 3; ++i) {
+      const vertex_t &e0 = t[i];
+      const vertex_t &e1 = t[(i + 1) % 3];
+      const float nx = e0.y - e1.y;
+      const float ny = e1.x - e0.x;
+      const float eps = 1e-5f * (fabsf(nx) + fabsf(ny)) * (fabsf(e0.x) + fabsf(e0.y) + 1.0f);
+
+      float min_t = +HUGE_VALF, max_t = -HUGE_VALF;
+      float min_u = +HUGE_VALF, max_u = -HUGE_VALF;
+      for (int j = 0; j < 3; ++j) {
+        const float dt = nx * t[j].x + ny * t[j].y;
+        const float du = nx * u[j].x + ny * u[j].y;
+        min_t = std::min(min_t, dt);
+        max_t = std::max(max_t, dt);
+        min_u = std::min(min_u, du);
+        max_u = std::max(max_u, du);
+      }
+      if ((max_t <= min_u + eps) || (max_u <= min_t + eps)) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  return !separated(ta, tb) && !separated(tb, ta);
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+bool CurveTriangulator::triangulate(const Glyph &glyph, Mesh_t &mesh)
+{
+  mesh.vertices.clear();
+  mesh.indices.clear();
+  mesh.num_interior_triangles = 0;
+  mesh.num_curve_triangles = 0;
+
+  segments_.clear();
+  path_offsets_.assign(1, 0);
+  for (int i = 0; i < glyph.getNumPaths(); ++i) {
+    glyph.getPath(i)->extractSegments(segments_);
+    path_offsets_.push_back(static_cast<int>(segments_.size()));
+  }
+  for (int i = 0; (i < kMaxSubdivisions) && subdivideOverlaps(); ++i) {}
+
+  // With the nonzero rule every contour keeps the filled side on the same
+  // hand, the left one when the glyph total area is counterclockwise.
+  float total_area = 0.0f;
+  for (const auto &s : segments_) {
+    total_area += s.p0.x * s.p2.y - s.p2.x * s.p0.y;
+  }
+  const float fill_side = (total_area >= 0.0f) ? 1.0f : -1.0f;
+
+  // Build the interior polygon and the curve triangles.
+  points_.clear();
+  polygon_segments_.clear();
+  std::vector<Vertex_t> &curves = mesh.vertices;
+
+  auto add_point = [this](const vertex_t &p) {
+    const int index = static_cast<int>(points_.size() / 2);
+    points_.push_back(p.x);
+    points_.push_back(p.y);
+    return index;
+  };
+
+  for (size_t i = 0; i + 1 < path_offsets_.size(); ++i) {
+    const int first_index = static_cast<int>(points_.size() / 2);
+    for (int j = path_offsets_[i]; j < path_offsets_[i+1]; ++j) {
+      const auto &s = segments_[j];
+      add_point(s.p0);
+
+      const float cross = Cross(s.p0, s.p1, s.p2);
+      if (0.0f == cross) {
+        continue;
+      }
+
+      // Curves bending into the glyph keep their control point in the
+      // polygon, their triangle covering the outside of the parabola.
+      const bool concave = (cross * fill_side < 0.0f);
+      if (concave) {
+        add_point(s.p1);
+      }
+      const float sign = (concave) ? -1.0f : 1.0f;
+      curves.push_back({ s.p0.x, s.p0.y, 0.0f, 0.0f, sign });
+      curves.push_back({ s.p1.x, s.p1.y, 0.5f, 0.0f, sign });
+      curves.push_back({ s.p2.x, s.p2.y, 1.0f, 1.0f, sign });
+    }
+
+    // Close the contour.
+    const int last_index = static_cast<int>(points_.size() / 2);
+    for (int j = first_index; j < last_index; ++j) {
+      polygon_segments_.push_back(j);
+      polygon_segments_.push_back((j + 1 < last_index) ? j + 1 : first_index);
+    }
+  }
+  mesh.num_curve_triangles = static_cast<int>(curves.size() / 3);
+
+  if (!triangulator_.triangulate(
+        points_.data(), 2, static_cast<int>(points_.size() / 2),
+        polygon_segments_.data(), static_cast<int>(polygon_segments_.size() / 2),
+        indices_)) {
+    return false;
+  }
+  mesh.num_interior_triangles = static_cast<int>(indices_.size() / 3);
+
+  // Curve triangles come first, followed by the interior polygon, whose
+  // coordinates are always covered.
+  const uint32_t num_curve_vertices = static_cast<uint32_t>(curves.size());
+  for (uint32_t i = 0; i < num_curve_vertices; ++i) {
+    mesh.indices.push_back(i);
+  }
+  for (size_t i = 0; i < points_.size(); i += 2) {
+    mesh.vertices.push_back({ points_[i], points_[i+1], 0.0f, 1.0f, 1.0f });
+  }
+  for (const auto index : indices_) {
+    mesh.indices.push_back(num_curve_vertices + index);
+  }
+
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool CurveTriangulator::subdivideOverlaps()
+{
+  const int num_segments = static_cast<int>(segments_.size());
+
+  overlaps_.assign(num_segments, 0u);
+  bool found = false;
+  for (int i = 0; i < num_segments; ++i) {
+    if (!IsCurve(segments_[i])) {
+      continue;
+    }
+    for (int j = 0; j < num_segments; ++j) {
+      if ((i != j) && Overlap(segments_[i], segments_[j])) {
+        overlaps_[i] = 1u;
+        found = true;
+        break;
+      }
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  // Split the overlapping curves at their middle.
+  subdivided_segments_.clear();
+  subdivided_offsets_.assign(1, 0);
+  for (size_t i = 0; i + 1 < path_offsets_.size(); ++i) {
+    for (int j = path_offsets_[i]; j < path_offsets_[i+1]; ++j) {
+      const auto &s = segments_[j];
+      if (!overlaps_[j]) {
+        subdivided_segments_.push_back(s);
+        continue;
+      }
+      const vertex_t a = Midpoint(s.p0, s.p1);
+      const vertex_t b = Midpoint(s.p1, s.p2);
+      const vertex_t m = Midpoint(a, b);
+      subdivided_segments_.push_back({ s.p0, a, m });
+      subdivided_segments_.push_back({ m, b, s.p2 });
+    }
+    subdivided_offsets_.push_back(static_cast<int>(subdivided_segments_.size()));
+  }
+  segments_.swap(subdivided_segments_);
+  path_offsets_.swap(subdivided_offsets_);
+
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,72 @@
+#ifndef FONTSAMPLER_CURVE_TRIANGULATOR_H_
+#define FONTSAMPLER_CURVE_TRIANGULATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "glyph.h"
+#include "triangulator.h"
+
+/* -------------------------------------------------------------------------- */
+
+/** Resolution independent triangulation of a Glyph, after Loop & Blinn.
+ * The interior polygon joins the on-curve points, and the control points of
+ * curves bending into the glyph. It is completed by one triangle per curve
+ * whose vertices carry the Bezier coordinates (u, v) of the curve control
+ * points, (0, 0), (0.5, 0) and (1, 1), and a sign. A fragment is covered
+ * when sign * (u^2 - v) < 0, interior triangles always being covered.
+ * Curves whose triangle overlaps another segment are subdivided first. */
+class CurveTriangulator {
+ public:
+  /* Maximum number of times a curve is subdivided to remove overlaps. */
+  static constexpr int kMaxSubdivisions = 4;
+
+  struct Vertex_t {
+    float x;
+    float y;
+    float u;
+    float v;
+    float sign;
+  };
+
+  struct Mesh_t {
+    std::vector<Vertex_t> vertices;
+    std::vector<uint32_t> indices;
+    int num_interior_triangles = 0;
+    int num_curve_triangles = 0;
+
+    int getNumTriangles() const {
+      return num_interior_triangles + num_curve_triangles;
+    }
+  };
+
+ public:
+  CurveTriangulator() = default;
+
+  /* Triangulate a glyph into mesh, replacing its content.
+   * @return false if the interior polygon could not be triangulated. */
+  bool triangulate(const Glyph &glyph, Mesh_t &mesh);
+
+ private:
+  /* Split in halves the curves whose triangle overlaps another segment,
+   * return false if none does. */
+  bool subdivideOverlaps();
+
+  Triangulator triangulator_;
+
+  // Segments of every paths.
+  std::vector<GlyphPath::Segment_t> segments_;
+  std::vector<int> path_offsets_;
+  std::vector<GlyphPath::Segment_t> subdivided_segments_;
+  std::vector<int> subdivided_offsets_;
+  std::vector<uint8_t> overlaps_;
+
+  // Interior polygon.
+  std::vector<float> points_;
+  std::vector<int> polygon_segments_;
+  std::vector<uint32_t> indices_;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_CURVE_TRIANGULATOR_H_
@@ -1,6 +1,7 @@
 #include "glyph.h"
 
 #include <cassert>
+#include <cfloat>
 #include <cmath>
 #include <algorithm>
 
@@ -35,6 +36,27 @@ float CalculateDistance(const vertex_t &p0, const vertex_t &p1)
   return sqrtf( x*x + y*y );
 }
 
+vertex_t Sub(const vertex_t &v1, const vertex_t &v2)
+{
+  return vertex_t(v1.x - v2.x, v1.y - v2.y);
+}
+
+vertex_t Normalize(const vertex_t &v)
+{
+  const float len = sqrtf(v.x*v.x + v.y*v.y);
+  return (len > 0.0f) ? vertex_t(v.x / len, v.y / len) : vertex_t(0.0f, 0.0f);
+}
+
+/* Tangent at a junction between two segments. */
+vertex_t JoinTangents(const vertex_t &t_in, const vertex_t &t_out)
+{
+  const auto &a = Normalize(t_in);
+  const auto &b = Normalize(t_out);
+  const auto &t = Normalize(vertex_t(a.x + b.x, a.y + b.y));
+  // Opposite tangents (cusp) fall back to the outgoing one.
+  return (t.x == 0.0f && t.y == 0.0f) ? b : t;
+}
+
 } // namespace ""
 
 /* -------------------------------------------------------------------------- */
@@ -43,21 +65,48 @@ float CalculateDistance(const vertex_t &p0, const vertex_t &p1)
 
 Glyph::Glyph(const glyph_data_t &glyph, float scale_x, float scale_y)
 {
+  const int num_paths = static_cast<int>(glyph.contour_ends.size());
+
+  // Each control point can at most add one mid anchor point.
+  const size_t max_vertices = 2 * glyph.coords.size();
+  vertices_.reserve(max_vertices);
+  flags_.reserve(max_vertices);
+  path_offsets_.reserve(num_paths + 1);
+  paths_.resize(num_paths);
+
+  min_bound_.set(+FLT_MAX, +FLT_MAX);
+  max_bound_.set(-FLT_MAX, -FLT_MAX);
+
   // Reconstruct curve paths.
-  paths_.resize(glyph.contour_ends.size());
-  const int num_paths = paths_.size();
   int first_index = 0;
   for (int i=0; i < num_paths; ++i) {
     const auto next_first_index = glyph.contour_ends[i] + 1;
     const auto num_vertices = next_first_index - first_index;
-    paths_[i].setup(
+    auto &path = paths_[i];
+
+    path_offsets_.push_back(static_cast<int>(vertices_.size()));
+    appendPath(
       &(glyph.coords[first_index]), 
       &(glyph.on_curve[first_index]), 
       num_vertices,
       scale_x,
-      scale_y
+      scale_y,
+      path.min_bound_,
+      path.max_bound_
     );
     first_index = next_first_index;
+
+    min_bound_.set(std::min(min_bound_.x, path.min_bound_.x), std::min(min_bound_.y, path.min_bound_.y));
+    max_bound_.set(std::max(max_bound_.x, path.max_bound_.x), std::max(max_bound_.y, path.max_bound_.y));
+  }
+  path_offsets_.push_back(static_cast<int>(vertices_.size()));
+
+  // Bind the paths to the buffers, now that they will not be reallocated.
+  for (int i=0; i < num_paths; ++i) {
+    auto &path = paths_[i];
+    path.vertices_ = vertices_.data() + path_offsets_[i];
+    path.flags_ = flags_.data() + path_offsets_[i];
+    path.num_vertices_ = path_offsets_[i+1] - path_offsets_[i];
   }
 
   // Detects simple inner paths.
@@ -80,27 +129,59 @@ Glyph::Glyph(const glyph_data_t &glyph, float scale_x, float scale_y)
   }
 }
 
+/* -------------------------------------------------------------------------- */
+
+Glyph::Glyph(const Glyph &outline, float scale_x, float scale_y)
+  : path_offsets_(outline.path_offsets_)
+  , paths_(outline.paths_)
+  , is_inner_paths_(outline.is_inner_paths_)
+{
+  min_bound_.set(+FLT_MAX, +FLT_MAX);
+  max_bound_.set(-FLT_MAX, -FLT_MAX);
+
+  // The paths keep pointing to the outline buffers, with a composed scale.
+  for (auto &path : paths_) {
+    path.scale_x_ *= scale_x;
+    path.scale_y_ *= scale_y;
+
+    // Negative scales swap the bounds.
+    const float x0 = scale_x * path.min_bound_.x, x1 = scale_x * path.max_bound_.x;
+    const float y0 = scale_y * path.min_bound_.y, y1 = scale_y * path.max_bound_.y;
+    path.min_bound_.set(std::min(x0, x1), std::min(y0, y1));
+    path.max_bound_.set(std::max(x0, x1), std::max(y0, y1));
+
+    min_bound_.set(std::min(min_bound_.x, path.min_bound_.x), std::min(min_bound_.y, path.min_bound_.y));
+    max_bound_.set(std::max(max_bound_.x, path.max_bound_.x), std::max(max_bound_.y, path.max_bound_.y));
+  }
+}
 
 /* -------------------------------------------------------------------------- */
 
-void GlyphPath::setup(const vertex_t *vertices,
-                      const int *flags,
-                      const int num_vertices,
-                      const float scale_x,
-                      const float scale_y)
+void Glyph::appendPath(const vertex_t *vertices,
+                       const int *flags,
+                       const int num_vertices,
+                       const float scale_x,
+                       const float scale_y,
+                       vertex_t &min_bound,
+                       vertex_t &max_bound)
 {
   /// Recreate in-between anchor points from the compressed
   /// curved representation.
   /// @note : points might need to be scaled up to avoid precision error
   ///         when downsampling.
 
-  // Calculate the number of points to add.
-  int num_sequential_cp = 0;
-  for (int i=1; i<num_vertices; ++i) {
-    num_sequential_cp += int((flags[i-1]&ON_CURVE) && (flags[i]&ON_CURVE));
-  }
-  vertices_.reserve(num_vertices + num_sequential_cp);
-  flags_.reserve(vertices_.size());
+  float min_x = +FLT_MAX, min_y = +FLT_MAX;
+  float max_x = -FLT_MAX, max_y = -FLT_MAX;
+
+  // Scale a vertex and accumulate its bounds in the same pass.
+  auto push = [&](const vertex_t &v, GlyphPath::FlagBits flag) {
+    const float x = scale_x * v.x;
+    const float y = scale_y * v.y;
+    min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+    min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+    vertices_.emplace_back(x, y);
+    flags_.push_back(flag);
+  };
 
   // Reconstruct mid anchor points from control points.
   for (int i=0; i<num_vertices; ++i)
@@ -108,75 +189,138 @@ void GlyphPath::setup(const vertex_t *vertices,
     // add the current vertex
     const int i0 = i % num_vertices;
     const auto &p0 = vertices[i0];
-    addVertex( p0, FlagBits(flags[i0]));
+    push(p0, (flags[i0] & GlyphPath::ON_CURVE) ? GlyphPath::ON_CURVE : GlyphPath::NONE);
 
     const int i1 = (i0+1) % num_vertices;
 
     // if both current and next are on the curve, continue.
-    if ((flags[i0]&ON_CURVE) || (flags[i1]&ON_CURVE)) {
+    if ((flags[i0] & GlyphPath::ON_CURVE) || (flags[i1] & GlyphPath::ON_CURVE)) {
       continue;
     }
 
     // otherwise both are control points, create mid anchor point.
     const auto &p1 = vertices[i1];
-    const auto &anchor_point = Lerp(p0, p1, 0.5f);
-    addVertex( anchor_point, ON_CURVE);
+    push(Lerp(p0, p1, 0.5f), GlyphPath::ON_CURVE);
   }
 
-  // Rescale the path and calculate its bounding box.
-  rescale(scale_x, scale_y);
+  min_bound.set(min_x, min_y);
+  max_bound.set(max_x, max_y);
 }
 
 /* -------------------------------------------------------------------------- */
 
-void GlyphPath::sample(Sampling_t &out, int subsamples, bool enable_segments_sampling) const
+void GlyphPath::sample(Sampling_t &out, 
+                       int subsamples, 
+                       bool enable_segments_sampling,
+                       bool enable_normals) const
 {
   assert(subsamples > 0);
 
   // Allocate memory for the sampled vertices.
   int on_curve_vertices = 0;
-  for (auto & flag : flags_) {
-    on_curve_vertices += int(flag & ON_CURVE);
+  for (int i = 0; i < num_vertices_; ++i) {
+    on_curve_vertices += int(flags_[i] & ON_CURVE);
   }
   const size_t approximate_size = on_curve_vertices * subsamples;
   out.vertices.reserve(approximate_size);
   out.distances.reserve(approximate_size);
   out.vertices.clear();
   out.distances.clear();
+  out.tangents.clear();
+  out.normals.clear();
+  if (enable_normals) {
+    out.tangents.reserve(approximate_size);
+    out.normals.reserve(approximate_size);
+  }
 
   // Sample the curve !
-  const int num_vertices = vertices_.size();  
+  const int num_vertices = num_vertices_;
   const float inv_subsamples = 1.0f / subsamples;
   const int first_index = (flags_[0] & ON_CURVE) ? 0 : 1;
   bool next_point_on_curve = false;
+
+  // Derivative directions at both ends of the segments.
+  vertex_t first_tangent(0.0f, 0.0f);
+  vertex_t last_tangent(0.0f, 0.0f);
+
   for (int i = first_index; i < num_vertices; i += (next_point_on_curve) ? 1 : 2)
   {
     const int i0 = (i+0) % num_vertices;
     const int i1 = (i+1) % num_vertices;
+    const int i2 = (i+2) % num_vertices;
 
     // this point is on the curve.
-    const auto &p0 = vertices_[i0];
-    out.addVertex(p0);
+    const auto p0 = at(i0);
 
     // this point is either on the curve or not.
-    const auto &p1 = vertices_[i1];
+    const auto p1 = at(i1);
+    const auto p2 = at(i2);
     next_point_on_curve = flags_[i1] & ON_CURVE;
 
+    const auto &start_tangent = Sub(p1, p0);
+    const auto &end_tangent = (next_point_on_curve) ? start_tangent : Sub(p2, p1);
+
+    if (enable_normals) {
+      if (out.vertices.empty()) {
+        first_tangent = start_tangent;
+        out.addVertex(p0, start_tangent);
+      } else {
+        out.addVertex(p0, JoinTangents(last_tangent, start_tangent));
+      }
+    } else {
+      out.addVertex(p0);
+    }
+    last_tangent = end_tangent;
+
     // special case : we subsample segment only if specified.
     if (next_point_on_curve && !enable_segments_sampling) {
       continue;
     }
 
     // Samples intermediate points.
-    const int i2 = (i+2) % num_vertices;
-    const auto &p2 = vertices_[i2];
     for (int s = 1; s < subsamples; ++s)
     {
       const float t = s * inv_subsamples;
       const auto &sampled_point = (next_point_on_curve) ? Lerp(p0, p1, t)
                                                         : EvaluateQuadraticBezier(p0, p1, p2, t)
                                                         ;
-      out.addVertex(sampled_point);
+      if (enable_normals) {
+        // B'(t) is proportional to lerp(p1 - p0, p2 - p1, t).
+        const auto &tangent = (next_point_on_curve) ? start_tangent 
+                                                    : Lerp(start_tangent, end_tangent, t)
+                                                    ;
+        out.addVertex(sampled_point, tangent);
+      } else {
+        out.addVertex(sampled_point);
+      }
+    }
+  }
+
+  // The first vertex joins the last segment of the closed path.
+  if (enable_normals && !out.vertices.empty()) {
+    const auto &t = JoinTangents(last_tangent, first_tangent);
+    out.tangents[0] = t;
+    out.normals[0] = vertex_t(t.y, -t.x);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphPath::extractSegments(std::vector<Segment_t> &out) const
+{
+  const int num_vertices = num_vertices_;
+  const int first_index = (flags_[0] & ON_CURVE) ? 0 : 1;
+  bool next_point_on_curve = false;
+  for (int i = first_index; i < num_vertices; i += (next_point_on_curve) ? 1 : 2)
+  {
+    const auto p0 = at(i % num_vertices);
+    const auto p1 = at((i+1) % num_vertices);
+    next_point_on_curve = flags_[(i+1) % num_vertices] & ON_CURVE;
+
+    if (next_point_on_curve) {
+      out.push_back({p0, Lerp(p0, p1, 0.5f), p1});
+    } else {
+      out.push_back({p0, p1, at((i+2) % num_vertices)});
     }
   }
 }
@@ -190,54 +334,54 @@ vertex_t GlyphPath::getCentroid() const
 
 /* -------------------------------------------------------------------------- */
 
-void GlyphPath::addVertex(const vertex_t &v, FlagBits flag)
+void GlyphPath::Sampling_t::addVertex(const vertex_t &v)
 {
-  vertices_.push_back(v);
-  flags_.push_back(flag);
+  float distance = 0.0f;
+  if (!vertices.empty()) {
+    const auto &last_vertex = vertices.back();
+    distance = distances.back() + CalculateDistance(last_vertex, v);
+  }
+  vertices.push_back(v);
+  distances.push_back(distance);
 }
 
 /* -------------------------------------------------------------------------- */
 
-void GlyphPath::rescale(float scale_x, float scale_y)
+void GlyphPath::Sampling_t::addVertex(const vertex_t &v, const vertex_t &tangent)
 {
-  std::for_each(vertices_.begin(), vertices_.end(), 
-    [scale_x, scale_y](auto &v) {
-      v.x *= scale_x;
-      v.y *= scale_y;
-  });
-  calculateAABB();
+  addVertex(v);
+  const auto &t = Normalize(tangent);
+  tangents.push_back(t);
+  normals.push_back(vertex_t(t.y, -t.x));
 }
 
 /* -------------------------------------------------------------------------- */
 
-void GlyphPath::calculateAABB()
+vertex_t GlyphPath::Sampling_t::evaluate(float delta) const
 {
-  auto resultX = std::minmax_element(vertices_.begin(), vertices_.end(), 
-    [](const auto &a, const auto &b) { return a.x < b.x; }
-  );
-  auto resultY = std::minmax_element(vertices_.begin(), vertices_.end(), 
-    [](const auto &a, const auto &b) { return a.y < b.y; }
-  );
-  min_bound_.set(resultX.first->x, resultY.first->y);
-  max_bound_.set(resultX.second->x, resultY.second->y);
+  size_t i1, i2;
+  float t;
+  locate(delta, i1, i2, t);
+  return Lerp(vertices[i1], vertices[i2], t);
 }
 
 /* -------------------------------------------------------------------------- */
 
-void GlyphPath::Sampling_t::addVertex(const vertex_t &v)
+vertex_t GlyphPath::Sampling_t::evaluateNormal(float delta) const
 {
-  float distance = 0.0f;
-  if (!vertices.empty()) {
-    const auto &last_vertex = vertices.back();
-    distance = distances.back() + CalculateDistance(last_vertex, v);
+  if (normals.empty()) {
+    return vertex_t(0.0f, 0.0f);
   }
-  vertices.push_back(v);
-  distances.push_back(distance);
+  size_t i1, i2;
+  float t;
+  locate(delta, i1, i2, t);
+  const auto &n = Normalize(Lerp(normals[i1], normals[i2], t));
+  return (n.x == 0.0f && n.y == 0.0f) ? normals[i1] : n;
 }
 
 /* -------------------------------------------------------------------------- */
 
-vertex_t GlyphPath::Sampling_t::evaluate(float delta) const
+void GlyphPath::Sampling_t::locate(float delta, size_t &i1, size_t &i2, float &t) const
 {
   // mirror delta to [0, 1] 
   delta = fmod(delta, 1.0f);
@@ -245,16 +389,12 @@ vertex_t GlyphPath::Sampling_t::evaluate(float delta) const
 
   const float dist = delta * length();
   const auto upper = std::upper_bound(distances.begin(), distances.end(), dist);
-  const size_t i1 = (std::distance(distances.begin(), upper)-1) % vertices.size(); 
-  const size_t i2 = (i1+1) % vertices.size();
-  const auto &v1 = vertices[i1];
-  const auto &v2 = vertices[i2];
+  i1 = (std::distance(distances.begin(), upper)-1) % vertices.size(); 
+  i2 = (i1+1) % vertices.size();
   const auto d1 = distances[i1];
   const auto d2 = (i2 < i1) ? length() : distances[i2];
 
-  const auto t = (dist - d1) / (d2 - d1);
-
-  return Lerp(v1, v2, t);
+  t = (dist - d1) / (d2 - d1);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -1,40 +1,15 @@
 #ifndef FONTSAMPLER_GLYPH_H_
 #define FONTSAMPLER_GLYPH_H_
 
-#include "ttf_structs.h"
-
-class GlyphPath;
-
-/* -------------------------------------------------------------------------- */
-
-class Glyph {
- public:
-  Glyph(const glyph_data_t &glyph, float scale_x, float scale_y);
-
-  explicit 
-  Glyph(const glyph_data_t &glyph)
-    : Glyph(glyph, 1.0f, 1.0f) 
-  {}
-
-  GlyphPath const* const getPath(int index) const {
-    return (index < getNumPaths()) ? &paths_[index] : nullptr;
-  }
-
-  int getNumPaths() const {
-    return static_cast<int>(paths_.size());
-  }
+#include <cstddef>
 
-  bool isInnerPath(int index) const {
-    return is_inner_paths_[index];
-  }
-
- private:
-  std::vector<GlyphPath> paths_;
-  std::vector<bool> is_inner_paths_;
-};
+#include "ttf_structs.h"
 
 /* -------------------------------------------------------------------------- */
 
+/** A single closed contour of a Glyph.
+ * GlyphPath does not own its data, it is a view on the contiguous buffers
+ * of its parent Glyph and is only valid as long as the Glyph is alive. */
 class GlyphPath {
  public:
   /** Discretized sampling of a GlyphPath. 
@@ -47,19 +22,43 @@ class GlyphPath {
     std::vector<vertex_t> vertices;
     std::vector<float> distances;
 
+    // Unit tangents and normals of each vertex, when requested.
+    std::vector<vertex_t> tangents;
+    std::vector<vertex_t> normals;
+
     void addVertex(const vertex_t &v);
+
+    /* Add a vertex with its (non normalized) tangent. */
+    void addVertex(const vertex_t &v, const vertex_t &tangent);
     
     /* Return a precise point on the curve given its absolute position.
      * @note Downsampling a curve from this method can easily bypass 
      * crest vertices. */
     vertex_t evaluate(float dt) const;
+
+    /* Return the interpolated unit normal at the given absolute position. */
+    vertex_t evaluateNormal(float dt) const;
     
     int size() const { return vertices.size(); }
     float length() const;
+    bool hasNormals() const { return !normals.empty(); }
+
+   private:
+    /* Find the vertices surrounding an absolute position and their
+     * interpolation factor. */
+    void locate(float dt, size_t &i1, size_t &i2, float &t) const;
+  };
+
+  /* Quadratic Bezier segment of a path.
+   * Straight segments have their control point at their middle. */
+  struct Segment_t {
+    vertex_t p0;
+    vertex_t p1;
+    vertex_t p2;
   };
 
   /* Information flag about the vertex. */
-  enum FlagBits : uint32_t {
+  enum FlagBits : uint8_t {
     NONE      = 0,
     ON_CURVE  = BitMask(0),
     RESERVED1 = BitMask(1),
@@ -77,17 +76,20 @@ class GlyphPath {
  public:
   GlyphPath() = default;
 
-  void setup(const vertex_t *vertices,
-             const int *flags,
-             const int num_vertices,
-             const float scale_x,
-             const float scale_y);
+  /* Create a discretized sampling of the curve.
+   * When enable_normals is set, the exact unit tangents and normals are
+   * derived from the curves derivatives in the same pass. At on-curve
+   * vertices they are averaged between the adjacent segments. */
+  void sample(Sampling_t &out, 
+              int subsamples = kDefaultSubSamples, 
+              bool enable_segments_sampling = false,
+              bool enable_normals = false) const;
 
-  /* Create a discretized sampling of the curve. */
-  void sample(Sampling_t &out, int subsamples = kDefaultSubSamples, bool enable_segments_sampling = false) const;
+  /* Append the segments of the path to out. */
+  void extractSegments(std::vector<Segment_t> &out) const;
 
-  inline int getNumVertices() const { return vertices_.size(); }
-  inline const vertex_t& getVertex(int index) const { return vertices_[index]; }
+  inline int getNumVertices() const { return num_vertices_; }
+  inline vertex_t getVertex(int index) const { return at(index); }
   inline const FlagBits& getFlag(int index) const { return flags_[index]; }
   inline const vertex_t& getMinBound() const { return min_bound_; }
   inline const vertex_t& getMaxBound() const { return max_bound_; }
@@ -95,18 +97,101 @@ class GlyphPath {
   vertex_t getCentroid() const;
 
  private:
-  /* Add a vertex with given flag to the path. */
-  void addVertex(const vertex_t &v, FlagBits flag);
+  friend class Glyph;
 
-  /* Calculate the path bounding box. */
-  void calculateAABB();
+  /* Vertex of the path, scaled. */
+  inline vertex_t at(int index) const {
+    return vertex_t(scale_x_ * vertices_[index].x, scale_y_ * vertices_[index].y);
+  }
+
+  // Curve parameters, stored in the parent Glyph.
+  const vertex_t *vertices_ = nullptr;
+  const FlagBits *flags_ = nullptr;
+  int num_vertices_ = 0;
 
-  /* Rescale each vertices and calculate the new bounds. */  
-  void rescale(float scale_x, float scale_y);
+  // Scale applied to the stored vertices when read, for scaled views.
+  float scale_x_ = 1.0f;
+  float scale_y_ = 1.0f;
 
-  // Curve parameters.
+  vertex_t min_bound_;
+  vertex_t max_bound_;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/** Outline of a glyph.
+ * All contours are stored back to back in a single vertices / flags buffer,
+ * each GlyphPath referencing its own range through the path offsets.
+ * A Glyph can be moved cheaply but not copied, as its paths point to
+ * its internal buffers.
+ * A scaled view of another Glyph shares its buffers, its paths scaling the 
+ * vertices as they are read, so several sizes of a font keep a single copy
+ * of the outlines. */
+class Glyph {
+ public:
+  Glyph(const glyph_data_t &glyph, float scale_x, float scale_y);
+
+  explicit 
+  Glyph(const glyph_data_t &glyph)
+    : Glyph(glyph, 1.0f, 1.0f) 
+  {}
+
+  /* Scaled view of outline, only valid as long as outline is alive. */
+  Glyph(const Glyph &outline, float scale_x, float scale_y);
+
+  Glyph(Glyph&&) = default;
+  Glyph& operator=(Glyph&&) = default;
+
+  Glyph(const Glyph&) = delete;
+  Glyph& operator=(const Glyph&) = delete;
+
+  GlyphPath const* const getPath(int index) const {
+    return (index < getNumPaths()) ? &paths_[index] : nullptr;
+  }
+
+  int getNumPaths() const {
+    return static_cast<int>(paths_.size());
+  }
+
+  bool isInnerPath(int index) const {
+    return is_inner_paths_[index];
+  }
+
+  /* Total number of vertices of all paths. */
+  int getNumVertices() const {
+    return path_offsets_.back();
+  }
+
+  /* Index of the first vertex of a path in the glyph buffers. */
+  int getPathOffset(int index) const {
+    return path_offsets_[index];
+  }
+
+  inline const vertex_t& getMinBound() const { return min_bound_; }
+  inline const vertex_t& getMaxBound() const { return max_bound_; }
+
+ private:
+  /* Reconstruct, rescale and append the vertices of a contour, 
+   * returning its bounding box. */
+  void appendPath(const vertex_t *vertices,
+                  const int *flags,
+                  const int num_vertices,
+                  const float scale_x,
+                  const float scale_y,
+                  vertex_t &min_bound,
+                  vertex_t &max_bound);
+
+  // Vertices and flags of every paths, contiguous, empty for views.
   std::vector<vertex_t> vertices_;
-  std::vector<FlagBits> flags_;
+  std::vector<GlyphPath::FlagBits> flags_;
+
+  // First vertex index of each paths, with a trailing total count.
+  std::vector<int> path_offsets_;
+
+  // Views on each paths.
+  std::vector<GlyphPath> paths_;
+  std::vector<bool> is_inner_paths_;
+
   vertex_t min_bound_;
   vertex_t max_bound_;
 };
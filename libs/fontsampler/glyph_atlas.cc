@@ -0,0 +1,305 @@
+#include "glyph_atlas.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+
+/* -------------------------------------------------------------------------- */
+
+GlyphAtlas::GlyphAtlas(int page_width, int page_height, int max_pages, int padding)
+  : page_width_(page_width)
+  , page_height_(page_height)
+  , max_pages_(std::max(max_pages, 1))
+  , padding_(std::max(padding, 0))
+{}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::clear()
+{
+  pages_.clear();
+  entries_.clear();
+  use_counter_ = 0u;
+  used_area_ = 0;
+  stats_ = Stats_t();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool GlyphAtlas::insert(uint32_t key, int width, int height, const uint8_t *pixels, int stride)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  // A bitmap fitting an empty page always finds room once every entry is
+  // evicted, so this is the only failure and the previous bitmap of the key
+  // is kept when it happens.
+  const int padded_width = width + padding_;
+  const int padded_height = height + padding_;
+  if ((padded_width > page_width_) || (padded_height > page_height_)) {
+    return false;
+  }
+
+  remove(key);
+
+  // When the atlas is full, first reclaim the area of the removed entries,
+  // then release the least recently used ones until the bitmap fits.
+  Region_t region;
+  bool found = allocate(padded_width, padded_height, region);
+  if (!found) {
+    repack();
+    found = allocate(padded_width, padded_height, region);
+  }
+  while (!found) {
+    evict(2 * padded_width * padded_height);
+    repack();
+    found = allocate(padded_width, padded_height, region);
+  }
+
+  region.width = width;
+  region.height = height;
+  blit(region, pixels, stride);
+
+  entries_[key] = { region, ++use_counter_ };
+  used_area_ += padded_width * padded_height;
+
+  // Update statistics.
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  stats_.num_entries = static_cast<int>(entries_.size());
+  stats_.num_insertions += 1;
+  stats_.last_insertion_us = elapsed.count();
+  stats_.max_insertion_us = std::max(stats_.max_insertion_us, elapsed.count());
+  stats_.total_insertion_us += elapsed.count();
+  updateOccupancy();
+
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+const GlyphAtlas::Region_t* GlyphAtlas::find(uint32_t key)
+{
+  auto it = entries_.find(key);
+  if (entries_.end() == it) {
+    return nullptr;
+  }
+  it->second.last_use = ++use_counter_;
+  return &it->second.region;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::remove(uint32_t key)
+{
+  auto it = entries_.find(key);
+  if (entries_.end() == it) {
+    return;
+  }
+  const auto &r = it->second.region;
+  used_area_ -= (r.width + padding_) * (r.height + padding_);
+  entries_.erase(it);
+
+  stats_.num_entries = static_cast<int>(entries_.size());
+  updateOccupancy();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::repack()
+{
+  struct Item_t {
+    uint32_t key;
+    Entry_t entry;
+    std::vector<uint8_t> pixels;
+  };
+
+  // Save the entries bitmaps before resetting the pages.
+  std::vector<Item_t> items;
+  items.reserve(entries_.size());
+  for (const auto &e : entries_) {
+    const auto &r = e.second.region;
+    const auto &page = pages_[r.page].page;
+
+    Item_t item{ e.first, e.second, std::vector<uint8_t>(r.width * r.height) };
+    for (int y = 0; y < r.height; ++y) {
+      memcpy(&item.pixels[y * r.width], &page.pixels[(r.y + y) * page.width + r.x], r.width);
+    }
+    items.push_back(std::move(item));
+  }
+
+  std::sort(items.begin(), items.end(), [](const Item_t &a, const Item_t &b) {
+    return (a.entry.region.height != b.entry.region.height)
+            ? a.entry.region.height > b.entry.region.height
+            : a.key < b.key;
+  });
+
+  pages_.clear();
+  entries_.clear();
+  used_area_ = 0;
+
+  for (auto &item : items) {
+    const int width = item.entry.region.width;
+    const int height = item.entry.region.height;
+
+    Region_t region;
+    if (!allocate(width + padding_, height + padding_, region)) {
+      stats_.num_evictions += 1;
+      continue;
+    }
+    region.width = width;
+    region.height = height;
+    blit(region, item.pixels.data(), width);
+
+    entries_[item.key] = { region, item.entry.last_use };
+    used_area_ += (width + padding_) * (height + padding_);
+  }
+
+  stats_.num_entries = static_cast<int>(entries_.size());
+  stats_.num_repacks += 1;
+  updateOccupancy();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool GlyphAtlas::allocate(PageData_t &data, int width, int height, int &out_x, int &out_y)
+{
+  auto &skyline = data.skyline;
+
+  // Bottom-left heuristic : lowest top edge, then tightest node.
+  int best_index = -1;
+  int best_y = INT_MAX;
+  int best_width = INT_MAX;
+  for (int i = 0; i < static_cast<int>(skyline.size()); ++i) {
+    const int x = skyline[i].x;
+    if (x + width > page_width_) {
+      break;
+    }
+
+    int y = 0;
+    int remaining = width;
+    for (int j = i; remaining > 0; ++j) {
+      y = std::max(y, skyline[j].y);
+      remaining -= skyline[j].width;
+    }
+    if (y + height > page_height_) {
+      continue;
+    }
+
+    if ((y < best_y) || ((y == best_y) && (skyline[i].width < best_width))) {
+      best_index = i;
+      best_y = y;
+      best_width = skyline[i].width;
+    }
+  }
+
+  if (best_index < 0) {
+    return false;
+  }
+
+  out_x = skyline[best_index].x;
+  out_y = best_y;
+
+  // Raise the skyline under the new rectangle.
+  skyline.insert(skyline.begin() + best_index, { out_x, best_y + height, width });
+  for (size_t i = best_index + 1; i < skyline.size(); ) {
+    const auto &prev = skyline[i - 1];
+    auto &node = skyline[i];
+    const int overlap = (prev.x + prev.width) - node.x;
+    if (overlap <= 0) {
+      break;
+    }
+    node.x += overlap;
+    node.width -= overlap;
+    if (node.width > 0) {
+      break;
+    }
+    skyline.erase(skyline.begin() + i);
+  }
+
+  // Merge neighbours of same height.
+  for (size_t i = 0; i + 1 < skyline.size(); ) {
+    if (skyline[i].y == skyline[i + 1].y) {
+      skyline[i].width += skyline[i + 1].width;
+      skyline.erase(skyline.begin() + i + 1);
+    } else {
+      ++i;
+    }
+  }
+
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool GlyphAtlas::allocate(int width, int height, Region_t &region)
+{
+  for (int i = 0; i < getNumPages(); ++i) {
+    if (allocate(pages_[i], width, height, region.x, region.y)) {
+      region.page = i;
+      return true;
+    }
+  }
+
+  if (getNumPages() >= max_pages_) {
+    return false;
+  }
+
+  addPage();
+  region.page = getNumPages() - 1;
+  return allocate(pages_.back(), width, height, region.x, region.y);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::addPage()
+{
+  PageData_t data;
+  data.page.width = page_width_;
+  data.page.height = page_height_;
+  data.page.pixels.resize(page_width_ * page_height_, 0u);
+  data.skyline.push_back({ 0, 0, page_width_ });
+  pages_.push_back(std::move(data));
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::evict(int area)
+{
+  std::vector<std::pair<uint64_t, uint32_t>> lru;
+  lru.reserve(entries_.size());
+  for (const auto &e : entries_) {
+    lru.emplace_back(e.second.last_use, e.first);
+  }
+  std::sort(lru.begin(), lru.end());
+
+  int released = 0;
+  for (const auto &u : lru) {
+    if (released >= area) {
+      break;
+    }
+    const auto &r = entries_[u.second].region;
+    released += (r.width + padding_) * (r.height + padding_);
+    remove(u.second);
+    stats_.num_evictions += 1;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::blit(const Region_t &region, const uint8_t *pixels, int stride)
+{
+  auto &page = pages_[region.page].page;
+  for (int y = 0; y < region.height; ++y) {
+    memcpy(&page.pixels[(region.y + y) * page.width + region.x], pixels + y * stride, region.width);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphAtlas::updateOccupancy()
+{
+  const int64_t total_area = static_cast<int64_t>(getNumPages()) * page_width_ * page_height_;
+  stats_.occupancy = (total_area > 0) ? static_cast<float>(used_area_) / total_area : 0.0f;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,141 @@
+#ifndef FONTSAMPLER_GLYPH_ATLAS_H_
+#define FONTSAMPLER_GLYPH_ATLAS_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* -------------------------------------------------------------------------- */
+
+/** Texture atlas of 8-bit glyph bitmaps.
+ * Bitmaps are inserted incrementally into CPU pages with a skyline bottom-left
+ * bin packer. When every page is full, the area of the removed entries is
+ * reclaimed by repacking them, then the least recently used entries are
+ * evicted until the bitmap fits.
+ * @note Regions move on eviction, they should be queried again after any
+ * insertion. */
+class GlyphAtlas {
+ public:
+  static constexpr int kDefaultPadding = 1;
+
+  /* Location of a bitmap in the atlas. */
+  struct Region_t {
+    int page;
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  struct Page_t {
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+  };
+
+  struct Stats_t {
+    int num_entries = 0;
+    int num_insertions = 0;
+    int num_evictions = 0;
+    int num_repacks = 0;
+
+    // Ratio of the pages area used by entries.
+    float occupancy = 0.0f;
+
+    // Insertion cost, in microseconds.
+    double last_insertion_us = 0.0;
+    double max_insertion_us = 0.0;
+    double total_insertion_us = 0.0;
+
+    double getAverageInsertionUs() const {
+      return (num_insertions > 0) ? total_insertion_us / num_insertions : 0.0;
+    }
+  };
+
+ public:
+  GlyphAtlas(int page_width, int page_height, int max_pages = 1, int padding = kDefaultPadding);
+
+  /* Remove every entries and pages. */
+  void clear();
+
+  /* Copy a bitmap to the atlas, replacing any previous bitmap of the same key.
+   * @return false if the bitmap can not fit in an empty page, the previous
+   *         bitmap of the key being kept. */
+  bool insert(uint32_t key, int width, int height, const uint8_t *pixels, int stride);
+
+  /* Return the region of a key and mark it as used, nullptr if absent. */
+  const Region_t* find(uint32_t key);
+
+  bool contains(uint32_t key) const {
+    return entries_.find(key) != entries_.end();
+  }
+
+  /* Remove a key from the atlas, its area is reclaimed on the next repack. */
+  void remove(uint32_t key);
+
+  /* Pack again every entries, from the tallest to the smallest. */
+  void repack();
+
+  int getNumPages() const {
+    return static_cast<int>(pages_.size());
+  }
+
+  const Page_t& getPage(int index) const {
+    return pages_[index].page;
+  }
+
+  const Stats_t& getStats() const {
+    return stats_;
+  }
+
+ private:
+  /* Segment of a page skyline. */
+  struct SkylineNode_t {
+    int x;
+    int y;
+    int width;
+  };
+
+  struct PageData_t {
+    Page_t page;
+    std::vector<SkylineNode_t> skyline;
+  };
+
+  struct Entry_t {
+    Region_t region;
+    uint64_t last_use;
+  };
+
+  /* Find room for a padded rectangle in a page skyline, return false if none. */
+  bool allocate(PageData_t &data, int width, int height, int &x, int &y);
+
+  /* Find room in any page, creating one if allowed. */
+  bool allocate(int width, int height, Region_t &region);
+
+  /* Add an empty page. */
+  void addPage();
+
+  /* Evict least recently used entries until at least area is released. */
+  void evict(int area);
+
+  /* Copy a bitmap to a region. */
+  void blit(const Region_t &region, const uint8_t *pixels, int stride);
+
+  void updateOccupancy();
+
+  int page_width_;
+  int page_height_;
+  int max_pages_;
+  int padding_;
+
+  std::vector<PageData_t> pages_;
+  std::unordered_map<uint32_t, Entry_t> entries_;
+  uint64_t use_counter_ = 0u;
+  int64_t used_area_ = 0;
+
+  Stats_t stats_;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_GLYPH_ATLAS_H_
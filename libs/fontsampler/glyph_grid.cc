@@ -0,0 +1,251 @@
+#include "glyph_grid.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "thread_pool.h"
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/* Number of points processed per parallel task of the batch queries. */
+constexpr int kPointsPerTask = 256;
+
+/* Squared distance from p to the segment [a, b], with its closest point. */
+float SquaredDistance(const vertex_t &p, const vertex_t &a, const vertex_t &b, vertex_t &closest) {
+  const float dx = b.x - a.x;
+  const float dy = b.y - a.y;
+  const float len2 = dx*dx + dy*dy;
+  float t = (len2 > 0.0f) ? ((p.x - a.x)*dx + (p.y - a.y)*dy) / len2 : 0.0f;
+  t = std::min(std::max(t, 0.0f), 1.0f);
+  closest.set(a.x + t*dx, a.y + t*dy);
+  const float ex = closest.x - p.x;
+  const float ey = closest.y - p.y;
+  return ex*ex + ey*ey;
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphGrid::build(const Glyph &glyph, int subsamples)
+{
+  // Flatten the paths.
+  segments_.clear();
+  GlyphPath::Sampling_t sampling;
+  for (int i = 0; i < glyph.getNumPaths(); ++i) {
+    glyph.getPath(i)->sample(sampling, subsamples, false);
+    const auto &v = sampling.vertices;
+    const int n = static_cast<int>(v.size());
+    for (int j = 0; j < n; ++j) {
+      segments_.push_back({ v[j], v[(j+1) % n] });
+    }
+  }
+
+  // Size the cells to hold a few segments each, following the glyph aspect.
+  const auto &min_bound = glyph.getMinBound();
+  const auto &max_bound = glyph.getMaxBound();
+  const float width = std::max(max_bound.x - min_bound.x, FLT_EPSILON);
+  const float height = std::max(max_bound.y - min_bound.y, FLT_EPSILON);
+  const float num_cells = std::max(static_cast<float>(segments_.size()) / kSegmentsPerCell, 1.0f);
+
+  origin_ = min_bound;
+  num_cols_ = std::max(static_cast<int>(roundf(sqrtf(num_cells * width / height))), 1);
+  num_rows_ = std::max(static_cast<int>(ceilf(num_cells / num_cols_)), 1);
+  cell_width_ = width / num_cols_;
+  cell_height_ = height / num_rows_;
+
+  // Bucket the segments by cells and rows, counting them first.
+  cell_offsets_.assign(num_cols_ * num_rows_ + 1, 0);
+  row_offsets_.assign(num_rows_ + 1, 0);
+
+  auto cell_range = [this](const Segment_t &s, int &x0, int &y0, int &x1, int &y1) {
+    x0 = cellX(std::min(s.p0.x, s.p1.x));
+    x1 = cellX(std::max(s.p0.x, s.p1.x));
+    y0 = cellY(std::min(s.p0.y, s.p1.y));
+    y1 = cellY(std::max(s.p0.y, s.p1.y));
+  };
+
+  int x0, y0, x1, y1;
+  for (const auto &s : segments_) {
+    cell_range(s, x0, y0, x1, y1);
+    for (int y = y0; y <= y1; ++y) {
+      row_offsets_[y + 1] += 1;
+      for (int x = x0; x <= x1; ++x) {
+        cell_offsets_[y * num_cols_ + x + 1] += 1;
+      }
+    }
+  }
+  for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+    cell_offsets_[i] += cell_offsets_[i-1];
+  }
+  for (size_t i = 1; i < row_offsets_.size(); ++i) {
+    row_offsets_[i] += row_offsets_[i-1];
+  }
+
+  cell_segments_.resize(cell_offsets_.back());
+  row_segments_.resize(row_offsets_.back());
+  std::vector<int> cell_fill(cell_offsets_.begin(), cell_offsets_.end() - 1);
+  std::vector<int> row_fill(row_offsets_.begin(), row_offsets_.end() - 1);
+  for (int i = 0; i < getNumSegments(); ++i) {
+    cell_range(segments_[i], x0, y0, x1, y1);
+    for (int y = y0; y <= y1; ++y) {
+      row_segments_[row_fill[y]++] = i;
+      for (int x = x0; x <= x1; ++x) {
+        cell_segments_[cell_fill[y * num_cols_ + x]++] = i;
+      }
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int GlyphGrid::winding(const vertex_t &p) const
+{
+  if (empty()
+   || (p.y < origin_.y)
+   || (p.y > origin_.y + num_rows_ * cell_height_)) {
+    return 0;
+  }
+
+  // Cast a ray to the right through the segments of the point row.
+  const int row = cellY(p.y);
+  int w = 0;
+  for (int i = row_offsets_[row]; i < row_offsets_[row + 1]; ++i) {
+    const auto &s = segments_[row_segments_[i]];
+    if ((s.p0.y <= p.y) == (s.p1.y <= p.y)) {
+      continue;
+    }
+    const float x = s.p0.x + (p.y - s.p0.y) * (s.p1.x - s.p0.x) / (s.p1.y - s.p0.y);
+    if (x > p.x) {
+      w += (s.p1.y > s.p0.y) ? 1 : -1;
+    }
+  }
+  return w;
+}
+
+/* -------------------------------------------------------------------------- */
+
+float GlyphGrid::distance(const vertex_t &p, vertex_t *nearest) const
+{
+  if (empty()) {
+    return FLT_MAX;
+  }
+
+  const int cx = cellX(p.x);
+  const int cy = cellY(p.y);
+
+  float best = FLT_MAX;
+  vertex_t best_point = p;
+  vertex_t closest;
+
+  // Visit rings of cells around the point cell, until none can hold a
+  // closer segment.
+  for (int r = 0; ; ++r) {
+    if ((cx - r < 0) && (cx + r >= num_cols_) && (cy - r < 0) && (cy + r >= num_rows_)) {
+      break;
+    }
+
+    if (r > 0) {
+      const float bx0 = origin_.x + (cx - r + 1) * cell_width_;
+      const float bx1 = origin_.x + (cx + r) * cell_width_;
+      const float by0 = origin_.y + (cy - r + 1) * cell_height_;
+      const float by1 = origin_.y + (cy + r) * cell_height_;
+      const bool inside = (p.x >= bx0) && (p.x <= bx1) && (p.y >= by0) && (p.y <= by1);
+      const float lower_bound = (inside) ? std::min({p.x - bx0, bx1 - p.x, p.y - by0, by1 - p.y}) : 0.0f;
+      if (lower_bound * lower_bound >= best) {
+        break;
+      }
+    }
+
+    for (int y = std::max(cy - r, 0); y <= std::min(cy + r, num_rows_ - 1); ++y) {
+      const bool ring_row = (y == cy - r) || (y == cy + r);
+      const int step = (ring_row || (r == 0)) ? 1 : 2 * r;
+      for (int x = cx - r; x <= cx + r; x += step) {
+        if ((x < 0) || (x >= num_cols_)) {
+          continue;
+        }
+
+        // Skip cells farther than the current best.
+        const float cell_x0 = origin_.x + x * cell_width_;
+        const float cell_y0 = origin_.y + y * cell_height_;
+        const float dx = std::max({cell_x0 - p.x, 0.0f, p.x - (cell_x0 + cell_width_)});
+        const float dy = std::max({cell_y0 - p.y, 0.0f, p.y - (cell_y0 + cell_height_)});
+        if (dx*dx + dy*dy >= best) {
+          continue;
+        }
+
+        const int cell = y * num_cols_ + x;
+        for (int i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+          const auto &s = segments_[cell_segments_[i]];
+          const float d = SquaredDistance(p, s.p0, s.p1, closest);
+          if (d < best) {
+            best = d;
+            best_point = closest;
+          }
+        }
+      }
+    }
+  }
+
+  if (nearest) {
+    *nearest = best_point;
+  }
+  return sqrtf(best);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphGrid::contains(const float *xy, int stride, int count, uint8_t *out, ThreadPool *pool) const
+{
+  auto process = [&](int begin, int end, int) {
+    for (int i = begin; i < end; ++i) {
+      const float *v = xy + i * stride;
+      out[i] = contains(vertex_t(v[0], v[1])) ? 1u : 0u;
+    }
+  };
+
+  if (pool) {
+    pool->parallelFor(count, kPointsPerTask, process);
+  } else {
+    process(0, count, 0);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void GlyphGrid::distance(const float *xy, int stride, int count, float *out, vertex_t *nearest, ThreadPool *pool) const
+{
+  auto process = [&](int begin, int end, int) {
+    for (int i = begin; i < end; ++i) {
+      const float *v = xy + i * stride;
+      out[i] = distance(vertex_t(v[0], v[1]), (nearest) ? &nearest[i] : nullptr);
+    }
+  };
+
+  if (pool) {
+    pool->parallelFor(count, kPointsPerTask, process);
+  } else {
+    process(0, count, 0);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int GlyphGrid::cellX(float x) const
+{
+  const int i = static_cast<int>(floorf((x - origin_.x) / cell_width_));
+  return std::min(std::max(i, 0), num_cols_ - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int GlyphGrid::cellY(float y) const
+{
+  const int i = static_cast<int>(floorf((y - origin_.y) / cell_height_));
+  return std::min(std::max(i, 0), num_rows_ - 1);
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,100 @@
+#ifndef FONTSAMPLER_GLYPH_GRID_H_
+#define FONTSAMPLER_GLYPH_GRID_H_
+
+#include <vector>
+
+#include "glyph.h"
+
+class ThreadPool;
+
+/* -------------------------------------------------------------------------- */
+
+/** Uniform grid over the flattened segments of a Glyph.
+ * It is built once and answers containment, with the nonzero winding rule,
+ * and nearest edge queries by only visiting the cells around a point.
+ * Queries are const and can be run concurrently. */
+class GlyphGrid {
+ public:
+  /* Average number of segments per cell targeted when building the grid. */
+  static constexpr int kSegmentsPerCell = 2;
+
+ public:
+  GlyphGrid() = default;
+
+  /* Flatten the glyph paths with subsamples per curve and build the grid. */
+  void build(const Glyph &glyph, int subsamples = GlyphPath::kDefaultSubSamples);
+
+  bool empty() const {
+    return segments_.empty();
+  }
+
+  int getNumSegments() const {
+    return static_cast<int>(segments_.size());
+  }
+
+  /* Winding number of the glyph around p. */
+  int winding(const vertex_t &p) const;
+
+  bool contains(const vertex_t &p) const {
+    return winding(p) != 0;
+  }
+
+  /* Distance from p to the closest edge, whose closest point is returned in
+   * nearest when not null. */
+  float distance(const vertex_t &p, vertex_t *nearest = nullptr) const;
+
+  /* Distance from p to the closest edge, negative inside the glyph. */
+  float signedDistance(const vertex_t &p) const {
+    const float d = distance(p);
+    return contains(p) ? -d : d;
+  }
+
+  // ---------------------------------------------------------------
+  // Batch queries over count points whose coordinates are read
+  // stride floats apart from xy. When a pool is given, the points
+  // are processed in parallel.
+  // ---------------------------------------------------------------
+
+  void contains(const float *xy, int stride, int count, uint8_t *out, ThreadPool *pool = nullptr) const;
+
+  void distance(const float *xy, int stride, int count, float *out, vertex_t *nearest = nullptr, ThreadPool *pool = nullptr) const;
+
+  void contains(const vertex_t *points, int count, uint8_t *out, ThreadPool *pool = nullptr) const {
+    contains(&points[0].x, 2, count, out, pool);
+  }
+
+  void distance(const vertex_t *points, int count, float *out, vertex_t *nearest = nullptr, ThreadPool *pool = nullptr) const {
+    distance(&points[0].x, 2, count, out, nearest, pool);
+  }
+
+ private:
+  struct Segment_t {
+    vertex_t p0;
+    vertex_t p1;
+  };
+
+  /* Cell coordinates of a point, clamped to the grid. */
+  int cellX(float x) const;
+  int cellY(float y) const;
+
+  // Flattened segments of every paths.
+  std::vector<Segment_t> segments_;
+
+  // Segments overlapping each cell, rows first.
+  std::vector<int> cell_offsets_;
+  std::vector<int> cell_segments_;
+
+  // Segments overlapping each row of cells, used for winding queries.
+  std::vector<int> row_offsets_;
+  std::vector<int> row_segments_;
+
+  vertex_t origin_;
+  float cell_width_ = 1.0f;
+  float cell_height_ = 1.0f;
+  int num_cols_ = 0;
+  int num_rows_ = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_GLYPH_GRID_H_
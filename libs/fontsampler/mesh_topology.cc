@@ -0,0 +1,63 @@
+#include "mesh_topology.h"
+
+#include "triangulator.h"
+
+/* -------------------------------------------------------------------------- */
+
+bool MeshTopology::update(
+  const float *xy,
+  int stride,
+  int num_points,
+  const int *segments,
+  int num_segments,
+  bool ear_clipping,
+  Triangulator &triangulator
+)
+{
+  const bool changed = (num_points != num_points_)
+                    || (num_segments != num_segments_)
+                    || (0u == version_);
+  if (changed) {
+    num_points_ = num_points;
+    num_segments_ = num_segments;
+    ++version_;
+
+    edge_indices_.clear();
+    edge_indices_.reserve(6 * num_segments);
+    for (int i = 0; i < num_segments; ++i) {
+      const uint32_t i1 = 2 * segments[2*i + 0];
+      const uint32_t i2 = 2 * segments[2*i + 1];
+
+      edge_indices_.push_back(i1 + 1);
+      edge_indices_.push_back(i1);
+      edge_indices_.push_back(i2 + 1);
+
+      edge_indices_.push_back(i2 + 1);
+      edge_indices_.push_back(i1);
+      edge_indices_.push_back(i2);
+    }
+  }
+
+  // The ear clipping of the first positions sampled with this topology is
+  // kept for the next ones.
+  if (ear_clipping && (face_version_ != version_)) {
+    face_version_ = version_;
+    triangulator.triangulate(xy, stride, num_points, segments, num_segments, face_indices_);
+  }
+
+  return changed;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void MeshTopology::clear()
+{
+  // The version keeps increasing so the indices built before are not
+  // mistaken for the next ones.
+  num_points_ = 0;
+  num_segments_ = 0;
+  face_indices_.clear();
+  edge_indices_.clear();
+}
+
+/* -------------------------------------------------------------------------- */
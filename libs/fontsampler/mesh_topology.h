@@ -0,0 +1,57 @@
+#ifndef FONTSAMPLER_MESH_TOPOLOGY_H_
+#define FONTSAMPLER_MESH_TOPOLOGY_H_
+
+#include <cstdint>
+#include <vector>
+
+class Triangulator;
+
+/* -------------------------------------------------------------------------- */
+
+/** Connectivity of the sampled geometry of a glyph, for its ear clipped face
+ * and its extruded edge.
+ * For a fixed subsamples count the sampled topology only changes with its
+ * counts. Its version is bumped on each change, and the indices built from
+ * an older version are rebuilt on the next update while they are kept as is
+ * otherwise, only the positions changing. */
+class MeshTopology {
+ public:
+  MeshTopology() = default;
+
+  /* Update the connectivity of num_points positions, read stride floats
+   * apart from xy, and of their contours given as num_segments pairs of
+   * point indices. The face is ear clipped when requested.
+   * @return true if the topology changed. */
+  bool update(const float *xy, int stride, int num_points, const int *segments, int num_segments, bool ear_clipping, Triangulator &triangulator);
+
+  /* Forget the topology, the next update rebuilding everything. */
+  void clear();
+
+  /* Version of the current topology, 0 before any update. */
+  uint32_t getVersion() const {
+    return version_;
+  }
+
+  /* Triangles of the ear clipped face, as triplets of point indices. */
+  const std::vector<uint32_t>& getFaceIndices() const {
+    return face_indices_;
+  }
+
+  /* Triangles of the edge, whose vertices alternate between the front and
+   * the back of each point. */
+  const std::vector<uint32_t>& getEdgeIndices() const {
+    return edge_indices_;
+  }
+
+ private:
+  int num_points_ = 0;
+  int num_segments_ = 0;
+  uint32_t version_ = 0u;
+  uint32_t face_version_ = 0u;
+  std::vector<uint32_t> face_indices_;
+  std::vector<uint32_t> edge_indices_;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_MESH_TOPOLOGY_H_
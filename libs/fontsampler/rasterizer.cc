@@ -0,0 +1,165 @@
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* -------------------------------------------------------------------------- */
+
+Rasterizer::Layout_t Rasterizer::GetLayout(const Glyph &glyph)
+{
+  const auto &min_bound = glyph.getMinBound();
+  const auto &max_bound = glyph.getMaxBound();
+
+  // Glyphes without contours, like spaces, keep unbounded limits.
+  Layout_t layout;
+  if ((0 == glyph.getNumPaths()) || (min_bound.x > max_bound.x) || (min_bound.y > max_bound.y)) {
+    return layout;
+  }
+
+  layout.left   = static_cast<int>(floorf(min_bound.x));
+  layout.top    = static_cast<int>(ceilf(max_bound.y));
+  layout.width  = static_cast<int>(ceilf(max_bound.x)) - layout.left;
+  layout.height = layout.top - static_cast<int>(floorf(min_bound.y));
+  return layout;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Rasterizer::rasterize(const Glyph &glyph, const Layout_t &layout, uint8_t *dst, int stride)
+{
+  width_ = layout.width;
+  height_ = layout.height;
+
+  // Edges can write one cell past the end of the last row.
+  accumulation_.assign(width_ * height_ + 2, 0.0f);
+
+  segments_.clear();
+  for (int i = 0; i < glyph.getNumPaths(); ++i) {
+    glyph.getPath(i)->extractSegments(segments_);
+  }
+
+  // Move to bitmap space, y pointing down.
+  const float left = static_cast<float>(layout.left);
+  const float top = static_cast<float>(layout.top);
+  for (const auto &s : segments_) {
+    const vertex_t p0(s.p0.x - left, top - s.p0.y);
+    const vertex_t p1(s.p1.x - left, top - s.p1.y);
+    const vertex_t p2(s.p2.x - left, top - s.p2.y);
+    addCurve(p0, p1, p2);
+  }
+
+  // Resolve the coverage as the running sum of the accumulation buffer.
+  const float *acc = accumulation_.data();
+  float coverage = 0.0f;
+  for (int y = 0; y < height_; ++y) {
+    uint8_t *row = dst + y * stride;
+    for (int x = 0; x < width_; ++x) {
+      coverage += *acc++;
+      const float alpha = std::min(fabsf(coverage), 1.0f);
+      row[x] = static_cast<uint8_t>(255.0f * alpha + 0.5f);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Rasterizer::addCurve(const vertex_t &p0, const vertex_t &p1, const vertex_t &p2)
+{
+  // The flattening error of a quadratic split in n is |p0 - 2 p1 + p2| / (4 n^2).
+  const float ddx = p0.x - 2.0f * p1.x + p2.x;
+  const float ddy = p0.y - 2.0f * p1.y + p2.y;
+  const float dd = sqrtf(ddx*ddx + ddy*ddy);
+  const int n = std::max(1, static_cast<int>(ceilf(sqrtf(dd / (4.0f * kFlatnessTolerance)))));
+
+  const float dt = 1.0f / n;
+  float x0 = p0.x;
+  float y0 = p0.y;
+  for (int i = 1; i < n; ++i) {
+    const float t = i * dt;
+    const float mt = 1.0f - t;
+    const float x1 = mt*mt * p0.x + 2.0f*mt*t * p1.x + t*t * p2.x;
+    const float y1 = mt*mt * p0.y + 2.0f*mt*t * p1.y + t*t * p2.y;
+    addLine(x0, y0, x1, y1);
+    x0 = x1;
+    y0 = y1;
+  }
+  addLine(x0, y0, p2.x, p2.y);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Rasterizer::addLine(float x0, float y0, float x1, float y1)
+{
+  if (y0 == y1) {
+    return;
+  }
+
+  // Walk the line from top to bottom, keeping its direction as a sign.
+  float direction = 1.0f;
+  if (y0 > y1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+    direction = -1.0f;
+  }
+
+  // Coverage left of the bitmap is accumulated on its first column.
+  const float max_x = static_cast<float>(width_);
+  x0 = std::min(std::max(x0, 0.0f), max_x);
+  x1 = std::min(std::max(x1, 0.0f), max_x);
+
+  const float dxdy = (x1 - x0) / (y1 - y0);
+  float x = x0;
+  if (y0 < 0.0f) {
+    x -= y0 * dxdy;
+  }
+
+  const int first_row = std::max(static_cast<int>(y0), 0);
+  const int last_row = std::min(static_cast<int>(ceilf(y1)), height_);
+  for (int y = first_row; y < last_row; ++y) {
+    float *row = accumulation_.data() + y * width_;
+
+    // Part of the line inside this row and its signed height.
+    const float dy = std::min(y + 1.0f, y1) - std::max(static_cast<float>(y), y0);
+    const float x_next = x + dxdy * dy;
+    const float d = dy * direction;
+
+    const float xa = std::min(x, x_next);
+    const float xb = std::max(x, x_next);
+    const float xa_floor = floorf(xa);
+    const int xa_i = static_cast<int>(xa_floor);
+    const float xb_ceil = ceilf(xb);
+    const int xb_i = static_cast<int>(xb_ceil);
+
+    if (xb_i <= xa_i + 1) {
+      // The line stays inside a single pixel column.
+      const float xmf = 0.5f * (x + x_next) - xa_floor;
+      row[xa_i]     += d - d * xmf;
+      row[xa_i + 1] += d * xmf;
+    } else {
+      // The line spans several columns, distribute its trapezoidal area.
+      const float s = 1.0f / (xb - xa);
+      const float xa_f = xa - xa_floor;
+      const float a0 = 0.5f * s * (1.0f - xa_f) * (1.0f - xa_f);
+      const float xb_f = xb - xb_ceil + 1.0f;
+      const float am = 0.5f * s * xb_f * xb_f;
+
+      row[xa_i] += d * a0;
+      if (xb_i == xa_i + 2) {
+        row[xa_i + 1] += d * (1.0f - a0 - am);
+      } else {
+        const float a1 = s * (1.5f - xa_f);
+        row[xa_i + 1] += d * (a1 - a0);
+        for (int xi = xa_i + 2; xi < xb_i - 1; ++xi) {
+          row[xi] += d * s;
+        }
+        const float a2 = a1 + (xb_i - xa_i - 3) * s;
+        row[xb_i - 1] += d * (1.0f - a2 - am);
+      }
+      row[xb_i] += d * am;
+    }
+
+    x = x_next;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,53 @@
+#ifndef FONTSAMPLER_RASTERIZER_H_
+#define FONTSAMPLER_RASTERIZER_H_
+
+#include <vector>
+
+#include "glyph.h"
+
+/* -------------------------------------------------------------------------- */
+
+/** Anti-aliased scanline rasterizer of glyph outlines.
+ * Each edge accumulates its exact signed area coverage into a buffer whose
+ * running sum gives the winding-weighted coverage of every pixel, resolved
+ * with the nonzero rule. Curves are flattened within kFlatnessTolerance.
+ * The accumulation buffer is kept between calls to avoid reallocations. */
+class Rasterizer {
+ public:
+  /* Maximum distance, in pixels, between a curve and its flattening. */
+  static constexpr float kFlatnessTolerance = 0.1f;
+
+  /* Layout of a glyph bitmap, relative to the glyph origin in pixels
+   * with the y-axis pointing up. */
+  struct Layout_t {
+    int left = 0;
+    int top = 0;
+    int width = 0;
+    int height = 0;
+  };
+
+ public:
+  /* Return the smallest bitmap layout containing a glyph with coordinates
+   * in pixels, 0x0 for glyphes without contours. */
+  static Layout_t GetLayout(const Glyph &glyph);
+
+  /* Write the 8-bit coverage of a glyph, with coordinates in pixels, into
+   * dst. Rows are written from top to bottom, stride bytes apart. */
+  void rasterize(const Glyph &glyph, const Layout_t &layout, uint8_t *dst, int stride);
+
+ private:
+  /* Accumulate the coverage of a line, in bitmap space. */
+  void addLine(float x0, float y0, float x1, float y1);
+
+  /* Flatten a quadratic curve, in bitmap space, as lines. */
+  void addCurve(const vertex_t &p0, const vertex_t &p1, const vertex_t &p2);
+
+  std::vector<float> accumulation_;
+  std::vector<GlyphPath::Segment_t> segments_;
+  int width_ = 0;
+  int height_ = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_RASTERIZER_H_
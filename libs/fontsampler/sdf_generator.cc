@@ -0,0 +1,339 @@
+#include "sdf_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "thread_pool.h"
+#include "ttf_reader.h"
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+constexpr float kCurveEpsilon = 1e-6f;
+
+/* Number of rows processed per parallel task. */
+constexpr int kRowsPerTask = 4;
+
+inline float Clamp01(float t) {
+  return std::min(std::max(t, 0.0f), 1.0f);
+}
+
+/* Quadratic segment in power basis, P(t) = p0 + 2t A + t^2 B. */
+struct Segment_t {
+  float p0x, p0y;
+  float p2x, p2y;
+  float ax, ay;
+  float bx, by;
+
+  // Dot products used by the distance solver.
+  float aa, ab, bb;
+  bool is_line;
+
+  // Control points bounding box.
+  float min_x, min_y;
+  float max_x, max_y;
+
+  explicit Segment_t(const GlyphPath::Segment_t &s)
+    : p0x(s.p0.x), p0y(s.p0.y)
+    , p2x(s.p2.x), p2y(s.p2.y)
+    , ax(s.p1.x - s.p0.x), ay(s.p1.y - s.p0.y)
+    , bx(s.p0.x - 2.0f*s.p1.x + s.p2.x), by(s.p0.y - 2.0f*s.p1.y + s.p2.y)
+  {
+    aa = ax*ax + ay*ay;
+    ab = ax*bx + ay*by;
+    bb = bx*bx + by*by;
+    is_line = (bb <= kCurveEpsilon * aa);
+
+    min_x = std::min({s.p0.x, s.p1.x, s.p2.x});
+    min_y = std::min({s.p0.y, s.p1.y, s.p2.y});
+    max_x = std::max({s.p0.x, s.p1.x, s.p2.x});
+    max_y = std::max({s.p0.y, s.p1.y, s.p2.y});
+  }
+
+  float x(float t) const { return p0x + t * (2.0f*ax + t*bx); }
+  float y(float t) const { return p0y + t * (2.0f*ay + t*by); }
+};
+
+/* Horizontal crossing of a segment with a row. */
+struct Crossing_t {
+  float x;
+  int direction;
+};
+
+/* Return the squared distance from (px, py) to a segment.
+ * The closest point parameter is a root of the cubic
+ *   t^3 (B.B) + 3 t^2 (A.B) + t (2 A.A + M.B) + M.A,  with M = p0 - P. */
+inline float SquaredDistance(const Segment_t &s, float px, float py) {
+  const float mx = s.p0x - px;
+  const float my = s.p0y - py;
+
+  auto distance2 = [&s, mx, my](float t) {
+    const float dx = mx + t * (2.0f*s.ax + t*s.bx);
+    const float dy = my + t * (2.0f*s.ay + t*s.by);
+    return dx*dx + dy*dy;
+  };
+
+  const float ma = mx*s.ax + my*s.ay;
+  float best = std::min(distance2(0.0f), distance2(1.0f));
+
+  if (s.is_line) {
+    return std::min(best, distance2(Clamp01(-ma / (2.0f * s.aa))));
+  }
+
+  const float mb = mx*s.bx + my*s.by;
+  const float inv_bb = 1.0f / s.bb;
+  const float k2 = 3.0f * s.ab * inv_bb;
+  const float k1 = (2.0f * s.aa + mb) * inv_bb;
+  const float k0 = ma * inv_bb;
+
+  // Depressed cubic u^3 + p u + q, with t = u - k2 / 3.
+  const float offset = - k2 / 3.0f;
+  const float p = k1 - k2 * k2 / 3.0f;
+  const float q = (2.0f * k2 * k2 * k2) / 27.0f - (k2 * k1) / 3.0f + k0;
+  const float discriminant = 0.25f * q * q + (p * p * p) / 27.0f;
+
+  if (discriminant >= 0.0f) {
+    const float sq = sqrtf(discriminant);
+    const float t = cbrtf(-0.5f * q + sq) + cbrtf(-0.5f * q - sq) + offset;
+    best = std::min(best, distance2(Clamp01(t)));
+  } else {
+    const float r = sqrtf(-p / 3.0f);
+    const float cos_arg = std::min(std::max(-q / (2.0f * r * r * r), -1.0f), 1.0f);
+    const float phi = acosf(cos_arg) / 3.0f;
+    const float two_pi_3 = 2.0943951f;
+    for (int k = 0; k < 3; ++k) {
+      const float t = 2.0f * r * cosf(phi - k * two_pi_3) + offset;
+      best = std::min(best, distance2(Clamp01(t)));
+    }
+  }
+
+  return best;
+}
+
+/* Add the crossings of a segment with the horizontal line at y.
+ * The segment is split in y-monotone pieces, each crossing at most once
+ * with a half-open rule so shared endpoints are counted a single time. */
+void AddCrossings(const Segment_t &s, float y, std::vector<Crossing_t> &out) {
+  float ts[3] = { 0.0f, 1.0f, 1.0f };
+  float ys[3] = { s.p0y, s.p2y, s.p2y };
+  int num_pieces = 1;
+
+  if (fabsf(s.by) > kCurveEpsilon) {
+    const float te = - s.ay / s.by;
+    if ((te > 0.0f) && (te < 1.0f)) {
+      ts[1] = te;
+      ys[1] = s.y(te);
+      num_pieces = 2;
+    }
+  }
+
+  for (int i = 0; i < num_pieces; ++i) {
+    const float ya = ys[i];
+    const float yb = ys[i+1];
+    if ((ya <= y) == (yb <= y)) {
+      continue;
+    }
+
+    // Solve by t^2 + 2 ay t + (p0y - y) = 0 on the piece.
+    const float ta = ts[i];
+    const float tb = ts[i+1];
+    const float c = s.p0y - y;
+    float t;
+    if (fabsf(s.by) <= kCurveEpsilon) {
+      t = - c / (2.0f * s.ay);
+    } else {
+      const float sq = sqrtf(std::max(s.ay * s.ay - s.by * c, 0.0f));
+      const float t1 = (-s.ay - sq) / s.by;
+      const float t2 = (-s.ay + sq) / s.by;
+      const float mid = 0.5f * (ta + tb);
+      t = (fabsf(t1 - mid) < fabsf(t2 - mid)) ? t1 : t2;
+    }
+    t = std::min(std::max(t, ta), tb);
+
+    out.push_back({ s.x(t), (yb > ya) ? 1 : -1 });
+  }
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+struct SDFGenerator::Shape_t {
+  std::vector<Segment_t> segments;
+};
+
+struct SDFGenerator::Scratch_t {
+  std::vector<float> distances;
+  std::vector<Crossing_t> crossings;
+};
+
+/* -------------------------------------------------------------------------- */
+
+SDFGenerator::SDFGenerator()
+  : SDFGenerator(ThreadPool::Shared())
+{}
+
+/* -------------------------------------------------------------------------- */
+
+void SDFGenerator::generate(const Glyph &glyph, SDFBitmap_t &out) const
+{
+  Shape_t shape;
+  setupShape(glyph, shape, out);
+
+  std::vector<Scratch_t> scratches(pool_.getConcurrency());
+  pool_.parallelFor(out.height, kRowsPerTask,
+    [&](int begin, int end, int participant) {
+      for (int row = begin; row < end; ++row) {
+        processRow(shape, out, row, scratches[participant]);
+      }
+  });
+}
+
+/* -------------------------------------------------------------------------- */
+
+int SDFGenerator::bake(TTFReader &reader,
+                       const std::u16string &charset,
+                       float size,
+                       std::vector<SDFBitmap_t> &out) const
+{
+  // Decode the outlines first, as the reader is not thread safe.
+  std::vector<glyph_data_t const*> glyphes_data;
+  std::vector<uint16_t> charcodes;
+  glyphes_data.reserve(charset.size());
+  charcodes.reserve(charset.size());
+  for (auto c : charset) {
+    if (auto *data = reader.get_glyph_data(c)) {
+      glyphes_data.push_back(data);
+      charcodes.push_back(c);
+    }
+  }
+
+  const int num_glyphes = static_cast<int>(glyphes_data.size());
+  const size_t first = out.size();
+  out.resize(first + num_glyphes);
+
+  // Scale the outlines to pixels and layout each bitmap.
+  std::vector<Shape_t> shapes(num_glyphes);
+  pool_.parallelFor(num_glyphes, 1, [&](int begin, int end, int) {
+    for (int i = begin; i < end; ++i) {
+      const Glyph glyph(*glyphes_data[i], size, size);
+      out[first + i].charcode = charcodes[i];
+      setupShape(glyph, shapes[i], out[first + i]);
+    }
+  });
+
+  // Process the rows of every glyphes as a single range.
+  std::vector<int> row_offsets(num_glyphes + 1, 0);
+  for (int i = 0; i < num_glyphes; ++i) {
+    row_offsets[i+1] = row_offsets[i] + out[first + i].height;
+  }
+
+  std::vector<Scratch_t> scratches(pool_.getConcurrency());
+  pool_.parallelFor(row_offsets.back(), kRowsPerTask,
+    [&](int begin, int end, int participant) {
+      int index = static_cast<int>(
+        std::upper_bound(row_offsets.begin(), row_offsets.end(), begin) - row_offsets.begin()
+      ) - 1;
+      for (int row = begin; row < end; ++row) {
+        while (row >= row_offsets[index+1]) {
+          ++index;
+        }
+        processRow(shapes[index], out[first + index], row - row_offsets[index], scratches[participant]);
+      }
+  });
+
+  return num_glyphes;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void SDFGenerator::setupShape(const Glyph &glyph, Shape_t &shape, SDFBitmap_t &bitmap) const
+{
+  std::vector<GlyphPath::Segment_t> segments;
+  for (int i = 0; i < glyph.getNumPaths(); ++i) {
+    glyph.getPath(i)->extractSegments(segments);
+  }
+  shape.segments.clear();
+  shape.segments.reserve(segments.size());
+  for (const auto &s : segments) {
+    shape.segments.emplace_back(s);
+  }
+
+  // Glyphes without contours, like spaces, keep unbounded limits.
+  const auto &min_bound = glyph.getMinBound();
+  const auto &max_bound = glyph.getMaxBound();
+  if ((0 == glyph.getNumPaths()) || (min_bound.x > max_bound.x) || (min_bound.y > max_bound.y)) {
+    bitmap.left   = 0;
+    bitmap.top    = 0;
+    bitmap.width  = 0;
+    bitmap.height = 0;
+    bitmap.pixels.clear();
+    return;
+  }
+
+  bitmap.left   = static_cast<int>(floorf(min_bound.x - spread_));
+  bitmap.top    = static_cast<int>(ceilf(max_bound.y + spread_));
+  bitmap.width  = static_cast<int>(ceilf(max_bound.x + spread_)) - bitmap.left;
+  bitmap.height = bitmap.top - static_cast<int>(floorf(min_bound.y - spread_));
+  bitmap.pixels.resize(bitmap.width * bitmap.height);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void SDFGenerator::processRow(const Shape_t &shape,
+                              SDFBitmap_t &bitmap,
+                              int row,
+                              Scratch_t &scratch) const
+{
+  const int width = bitmap.width;
+  const float x0 = bitmap.left + 0.5f;
+  const float y = bitmap.top - (row + 0.5f);
+
+  auto &distances = scratch.distances;
+  auto &crossings = scratch.crossings;
+  distances.assign(width, spread_ * spread_);
+  crossings.clear();
+
+  for (const auto &s : shape.segments) {
+    if ((y < s.min_y - spread_) || (y > s.max_y + spread_)) {
+      continue;
+    }
+
+    if ((y >= s.min_y) && (y <= s.max_y)) {
+      AddCrossings(s, y, crossings);
+    }
+
+    // Only pixels within the spread of the segment bounding box are affected.
+    const int first = std::max(static_cast<int>(floorf(s.min_x - spread_ - x0)), 0);
+    const int last  = std::min(static_cast<int>(ceilf(s.max_x + spread_ - x0)) + 1, width);
+    float *d = distances.data();
+    for (int i = first; i < last; ++i) {
+      d[i] = std::min(d[i], SquaredDistance(s, x0 + i, y));
+    }
+  }
+
+  // Nonzero winding of the ray going right from each pixel.
+  std::sort(crossings.begin(), crossings.end(),
+    [](const Crossing_t &a, const Crossing_t &b) { return a.x < b.x; }
+  );
+  int winding = 0;
+  for (const auto &c : crossings) {
+    winding += c.direction;
+  }
+
+  const float inv_range = 0.5f / spread_;
+  uint8_t *dst = bitmap.pixels.data() + row * width;
+  size_t k = 0;
+  for (int i = 0; i < width; ++i) {
+    const float x = x0 + i;
+    for (; (k < crossings.size()) && (crossings[k].x <= x); ++k) {
+      winding -= crossings[k].direction;
+    }
+    const float d = sqrtf(distances[i]);
+    const float signed_distance = (winding != 0) ? d : -d;
+    dst[i] = static_cast<uint8_t>(255.0f * Clamp01(0.5f + signed_distance * inv_range) + 0.5f);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,84 @@
+#ifndef FONTSAMPLER_SDF_GENERATOR_H_
+#define FONTSAMPLER_SDF_GENERATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "glyph.h"
+
+class ThreadPool;
+class TTFReader;
+
+/* -------------------------------------------------------------------------- */
+
+/** 8-bit signed distance field of a glyph.
+ * A value of 128 lies on the outline, higher values are inside the glyph.
+ * Rows are stored from top to bottom. */
+struct SDFBitmap_t {
+  uint16_t charcode = 0;
+  int width = 0;
+  int height = 0;
+
+  // Top-left corner of the bitmap relative to the glyph origin, in pixels
+  // with the y-axis pointing up.
+  int left = 0;
+  int top = 0;
+
+  std::vector<uint8_t> pixels;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/** Generate signed distance fields from glyph outlines.
+ * Distances are exact to the quadratic segments of the paths and their sign
+ * is resolved with the nonzero winding rule. Rows are processed in parallel,
+ * and so are the glyphs of a charset. */
+class SDFGenerator {
+ public:
+  /* Default distance, in pixels, mapped to the [0, 255] range. */
+  static constexpr float kDefaultSpread = 4.0f;
+
+  /* Use the shared thread pool. */
+  SDFGenerator();
+
+  explicit SDFGenerator(ThreadPool &pool)
+    : pool_(pool)
+  {}
+
+  float getSpread() const {
+    return spread_;
+  }
+
+  void setSpread(float spread) {
+    spread_ = spread;
+  }
+
+  /* Generate the distance field of a glyph with coordinates in pixels.
+   * Glyphes without contours get an empty 0x0 bitmap. */
+  void generate(const Glyph &glyph, SDFBitmap_t &out) const;
+
+  /* Generate the distance fields of every characters of charset at the given
+   * size, in pixels per em. Missing glyphes are skipped.
+   * @return the number of distance fields generated. */
+  int bake(TTFReader &reader,
+           const std::u16string &charset,
+           float size,
+           std::vector<SDFBitmap_t> &out) const;
+
+ private:
+  struct Shape_t;
+  struct Scratch_t;
+
+  /* Setup the shape segments and the bitmap layout of a glyph. */
+  void setupShape(const Glyph &glyph, Shape_t &shape, SDFBitmap_t &bitmap) const;
+
+  /* Calculate a single row of a distance field. */
+  void processRow(const Shape_t &shape, SDFBitmap_t &bitmap, int row, Scratch_t &scratch) const;
+
+  ThreadPool &pool_;
+  float spread_ = kDefaultSpread;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_SDF_GENERATOR_H_
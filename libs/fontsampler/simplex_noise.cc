@@ -0,0 +1,170 @@
+#include "simplex_noise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/* Number of points processed at once by the batch versions. */
+constexpr int kBlockSize = 256;
+
+/* Points are evaluated by groups of kLanes, so the noise loop count is a
+ * multiple of any vector width and needs no scalar epilogue. */
+constexpr int kLanes = 8;
+
+/* Skewing factors between the cubic and the simplex lattices. */
+constexpr float kSkew = 1.0f / 3.0f;
+constexpr float kUnskew = 1.0f / 6.0f;
+
+/* Scale bringing the sum of the corners contributions to [-1, 1]. */
+constexpr float kScale = 32.0f;
+
+inline int FastFloor(float x) {
+  const int i = static_cast<int>(x);
+  return i - static_cast<int>(x < static_cast<float>(i));
+}
+
+/* Lattice coordinates are hashed as the xor of their products by these
+ * primes, so neighbouring corners only add the primes to the cell products. */
+constexpr uint32_t kPrimeX = 0x8da6b343u;
+constexpr uint32_t kPrimeY = 0xd8163841u;
+constexpr uint32_t kPrimeZ = 0xcb1ab31fu;
+
+inline uint32_t Hash(uint32_t hx, uint32_t hy, uint32_t hz) {
+  uint32_t h = hx ^ hy ^ hz;
+  h ^= h >> 15;
+  h *= 0x2c1b3c6du;
+  h ^= h >> 12;
+  return h;
+}
+
+/* Return value when mask is set, 0 otherwise. */
+inline uint32_t Select(int mask, uint32_t value) {
+  return static_cast<uint32_t>(-mask) & value;
+}
+
+/* Dot product with a cube edge gradient picked by the hash. The gradient has
+ * a null coordinate on one axis and random signs on the two others, the
+ * z-axis being nulled twice as often, as with Perlin's 16 gradients. */
+inline float Gradient(uint32_t hash, float x, float y, float z) {
+  const uint32_t axis = (hash >> 8) & 3u;
+  const int gx = static_cast<int>(axis != 0u) * (1 - 2 * static_cast<int>((hash >> 4) & 1u));
+  const int gy = static_cast<int>(axis != 1u) * (1 - 2 * static_cast<int>((hash >> 5) & 1u));
+  const int gz = static_cast<int>(axis < 2u) * (1 - 2 * static_cast<int>((hash >> 6) & 1u));
+  return static_cast<float>(gx) * x + static_cast<float>(gy) * y + static_cast<float>(gz) * z;
+}
+
+/* Contribution of a simplex corner at offset (x, y, z) from the point. */
+inline float Corner(uint32_t hash, float x, float y, float z) {
+  // Clamp to zero arithmetically, a select being turned into a branch.
+  const float r = 0.6f - x*x - y*y - z*z;
+  const float t = 0.5f * (r + std::fabs(r));
+  const float t2 = t * t;
+  return t2 * t2 * Gradient(hash, x, y, z);
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+float SimplexNoise::Evaluate(float x, float y, float z)
+{
+  const float xyz[3] = { x, y, z };
+  float out;
+  Evaluate(xyz, 3, 1, 1.0f, 0.0f, &out);
+  return out;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void SimplexNoise::Evaluate(const float *xyz, int stride, int count, float frequency, float time, float *out)
+{
+  // Gather the coordinates by blocks so the noise loop runs on contiguous
+  // arrays.
+  float x[kBlockSize];
+  float y[kBlockSize];
+  float z[kBlockSize];
+  float noise[kBlockSize];
+
+  for (int first = 0; first < count; first += kBlockSize) {
+    const int n = std::min(kBlockSize, count - first);
+    const float *v = xyz + first * stride;
+    for (int i = 0; i < n; ++i) {
+      x[i] = frequency * v[i * stride + 0] + time;
+      y[i] = frequency * v[i * stride + 1] + time;
+      z[i] = frequency * v[i * stride + 2] + time;
+    }
+
+    const int num_groups = (n + kLanes - 1) / kLanes;
+    std::fill(x + n, x + num_groups * kLanes, 0.0f);
+    std::fill(y + n, y + num_groups * kLanes, 0.0f);
+    std::fill(z + n, z + num_groups * kLanes, 0.0f);
+
+    // The whole kernel is kept in the loop body so it can be vectorized.
+    for (int p = 0; p < num_groups * kLanes; ++p) {
+      // Cell of the simplex lattice.
+      const float s = (x[p] + y[p] + z[p]) * kSkew;
+      const int i = FastFloor(x[p] + s);
+      const int j = FastFloor(y[p] + s);
+      const int k = FastFloor(z[p] + s);
+      const float t = static_cast<float>(i + j + k) * kUnskew;
+      const float x0 = x[p] - (static_cast<float>(i) - t);
+      const float y0 = y[p] - (static_cast<float>(j) - t);
+      const float z0 = z[p] - (static_cast<float>(k) - t);
+
+      // Rank the coordinates to find the simplex, in [0, 2] per axis.
+      const int rx = (x0 >= y0) + (x0 >= z0);
+      const int ry = (y0 >  x0) + (y0 >= z0);
+      const int rz = (z0 >  x0) + (z0 >  y0);
+      const int i1 = (rx >= 2), j1 = (ry >= 2), k1 = (rz >= 2);
+      const int i2 = (rx >= 1), j2 = (ry >= 1), k2 = (rz >= 1);
+
+      const float x1 = x0 - i1 + kUnskew;
+      const float y1 = y0 - j1 + kUnskew;
+      const float z1 = z0 - k1 + kUnskew;
+      const float x2 = x0 - i2 + 2.0f * kUnskew;
+      const float y2 = y0 - j2 + 2.0f * kUnskew;
+      const float z2 = z0 - k2 + 2.0f * kUnskew;
+      const float x3 = x0 - 1.0f + 3.0f * kUnskew;
+      const float y3 = y0 - 1.0f + 3.0f * kUnskew;
+      const float z3 = z0 - 1.0f + 3.0f * kUnskew;
+
+      const uint32_t hx = static_cast<uint32_t>(i) * kPrimeX;
+      const uint32_t hy = static_cast<uint32_t>(j) * kPrimeY;
+      const uint32_t hz = static_cast<uint32_t>(k) * kPrimeZ;
+      const float sum =
+          Corner(Hash(hx, hy, hz), x0, y0, z0)
+        + Corner(Hash(hx + Select(i1, kPrimeX), hy + Select(j1, kPrimeY), hz + Select(k1, kPrimeZ)), x1, y1, z1)
+        + Corner(Hash(hx + Select(i2, kPrimeX), hy + Select(j2, kPrimeY), hz + Select(k2, kPrimeZ)), x2, y2, z2)
+        + Corner(Hash(hx + kPrimeX, hy + kPrimeY, hz + kPrimeZ), x3, y3, z3);
+      noise[p] = kScale * sum;
+    }
+    std::copy(noise, noise + n, out + first);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void SimplexNoise::Displace(float *xyz, const float *normals, int stride, int count, const Params_t &params)
+{
+  float noise[kBlockSize];
+
+  for (int first = 0; first < count; first += kBlockSize) {
+    const int n = std::min(kBlockSize, count - first);
+    float *v = xyz + first * stride;
+    const float *normal = normals + first * stride;
+
+    Evaluate(v, stride, n, params.frequency, params.time, noise);
+    for (int i = 0; i < n; ++i) {
+      const float scale = params.amplitude * (params.bias + noise[i]);
+      v[i * stride + 0] += scale * normal[i * stride + 0];
+      v[i * stride + 1] += scale * normal[i * stride + 1];
+      v[i * stride + 2] += scale * normal[i * stride + 2];
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
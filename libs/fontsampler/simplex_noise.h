@@ -0,0 +1,35 @@
+#ifndef FONTSAMPLER_SIMPLEX_NOISE_H_
+#define FONTSAMPLER_SIMPLEX_NOISE_H_
+
+/* -------------------------------------------------------------------------- */
+
+/** 3D simplex noise, with values in [-1, 1].
+ * Lattice gradients are picked from an integer hash rather than a permutation
+ * table and the simplex corners are ranked without branches, so the batch
+ * versions compile to vectorized loops. */
+class SimplexNoise {
+ public:
+  /* Displacement of vertices along their normals, by
+   * amplitude * (bias + noise(frequency * position + time)). */
+  struct Params_t {
+    float amplitude = 1.0f;
+    float frequency = 1.0f;
+    float time = 0.0f;
+    float bias = 0.0f;
+  };
+
+ public:
+  static float Evaluate(float x, float y, float z);
+
+  /* Noise at count points whose coordinates are read stride floats apart from
+   * xyz, scaled by frequency and offset by time on each axis. */
+  static void Evaluate(const float *xyz, int stride, int count, float frequency, float time, float *out);
+
+  /* Displace count vertices along their normals, both read stride floats
+   * apart. */
+  static void Displace(float *xyz, const float *normals, int stride, int count, const Params_t &params);
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_SIMPLEX_NOISE_H_
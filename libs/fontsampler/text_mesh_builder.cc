@@ -0,0 +1,179 @@
+#include "text_mesh_builder.h"
+
+#include <algorithm>
+#include <cstring>
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+inline void Transform(const float m[12], float x, float y, float z, TextMeshBuilder::Vertex_t &out) {
+  out.x = m[0] * x + m[1] * y + m[2]  * z + m[3];
+  out.y = m[4] * x + m[5] * y + m[6]  * z + m[7];
+  out.z = m[8] * x + m[9] * y + m[10] * z + m[11];
+}
+
+inline void SetColor(const float color[4], TextMeshBuilder::Vertex_t &out) {
+  out.r = color[0];
+  out.g = color[1];
+  out.b = color[2];
+  out.a = color[3];
+}
+
+inline bool SameParams(TextMeshBuilder::Params_t const& a, TextMeshBuilder::Params_t const& b) {
+  return (a.extrusion == b.extrusion)
+      && (0 == std::memcmp(a.colors, b.colors, sizeof(a.colors)));
+}
+
+inline int NumVertices(TextMeshBuilder::Source_t const& source) {
+  return 2 * source.num_face_vertices + source.num_edge_vertices;
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+TextMeshBuilder::Changes_t TextMeshBuilder::build(const Instance_t *instances, int count, Params_t const& params)
+{
+  Changes_t changes;
+
+  // Keep the indices when every occurrence keeps its topology.
+  changes.layout = (static_cast<int>(records_.size()) != count);
+  for (int i = 0; (i < count) && !changes.layout; ++i) {
+    changes.layout = !HasSameLayout(instances[i], records_[i]);
+  }
+
+  if (changes.layout) {
+    records_.resize(count);
+    indices_.clear();
+
+    int num_vertices = 0;
+    for (int i = 0; i < count; ++i) {
+      const auto &source = *instances[i].source;
+      auto &record = records_[i];
+      record.topology          = source.topology;
+      record.revision          = source.revision;
+      record.num_face_vertices = source.num_face_vertices;
+      record.num_face_indices  = source.num_face_indices;
+      record.num_edge_vertices = source.num_edge_vertices;
+      record.num_edge_indices  = source.num_edge_indices;
+      std::copy(instances[i].transform, instances[i].transform + 12, record.transform);
+      record.first_vertex      = num_vertices;
+      num_vertices += NumVertices(source);
+    }
+    vertices_.resize(num_vertices);
+    params_ = params;
+
+    for (int i = 0; i < count; ++i) {
+      writeVertices(instances[i], records_[i], params);
+      writeIndices(instances[i], records_[i]);
+    }
+
+    changes.first_vertex = 0;
+    changes.num_vertices = num_vertices;
+    return changes;
+  }
+
+  // Otherwise only rewrite the vertices of the occurrences which changed.
+  const bool all = !SameParams(params, params_);
+  params_ = params;
+
+  int first = static_cast<int>(vertices_.size());
+  int last = 0;
+  for (int i = 0; i < count; ++i) {
+    const auto &instance = instances[i];
+    auto &record = records_[i];
+
+    const bool moved = !std::equal(instance.transform, instance.transform + 12, record.transform);
+    if (!all && !moved && (instance.source->revision == record.revision)) {
+      continue;
+    }
+    record.revision = instance.source->revision;
+    std::copy(instance.transform, instance.transform + 12, record.transform);
+    writeVertices(instance, record, params);
+
+    first = std::min(first, record.first_vertex);
+    last = std::max(last, record.first_vertex + NumVertices(*instance.source));
+  }
+
+  if (last > first) {
+    changes.first_vertex = first;
+    changes.num_vertices = last - first;
+  }
+  return changes;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void TextMeshBuilder::clear()
+{
+  vertices_.clear();
+  indices_.clear();
+  records_.clear();
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool TextMeshBuilder::HasSameLayout(Instance_t const& instance, Record_t const& record)
+{
+  const auto &source = *instance.source;
+  return (source.topology == record.topology)
+      && (source.num_face_vertices == record.num_face_vertices)
+      && (source.num_face_indices  == record.num_face_indices)
+      && (source.num_edge_vertices == record.num_edge_vertices)
+      && (source.num_edge_indices  == record.num_edge_indices);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void TextMeshBuilder::writeVertices(Instance_t const& instance, Record_t const& record, Params_t const& params)
+{
+  const auto &source = *instance.source;
+  const float *m = instance.transform;
+  const int stride = source.stride;
+
+  Vertex_t *front = vertices_.data() + record.first_vertex;
+  Vertex_t *back = front + source.num_face_vertices;
+  Vertex_t *edge = back + source.num_face_vertices;
+
+  for (int i = 0; i < source.num_face_vertices; ++i) {
+    const float *v = source.face_vertices + i * stride;
+    Transform(m, v[0], v[1], v[2], front[i]);
+    Transform(m, v[0], v[1], v[2] - params.extrusion, back[i]);
+    SetColor(params.colors[kFront], front[i]);
+    SetColor(params.colors[kBack], back[i]);
+  }
+
+  for (int i = 0; i < source.num_edge_vertices; ++i) {
+    const float *v = source.edge_vertices + i * stride;
+    Transform(m, v[0], v[1], params.extrusion * v[2], edge[i]);
+    SetColor(params.colors[kEdge], edge[i]);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void TextMeshBuilder::writeIndices(Instance_t const& instance, Record_t const& record)
+{
+  const auto &source = *instance.source;
+  const uint32_t front = static_cast<uint32_t>(record.first_vertex);
+  const uint32_t back = front + source.num_face_vertices;
+  const uint32_t edge = back + source.num_face_vertices;
+
+  for (int i = 0; i < source.num_face_indices; ++i) {
+    indices_.push_back(front + source.face_indices[i]);
+  }
+
+  // The back faces the other way.
+  for (int i = 0; i + 2 < source.num_face_indices; i += 3) {
+    indices_.push_back(back + source.face_indices[i + 0]);
+    indices_.push_back(back + source.face_indices[i + 2]);
+    indices_.push_back(back + source.face_indices[i + 1]);
+  }
+
+  for (int i = 0; i < source.num_edge_indices; ++i) {
+    indices_.push_back(edge + source.edge_indices[i]);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
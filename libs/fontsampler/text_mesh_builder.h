@@ -0,0 +1,121 @@
+#ifndef FONTSAMPLER_TEXT_MESH_BUILDER_H_
+#define FONTSAMPLER_TEXT_MESH_BUILDER_H_
+
+#include <cstdint>
+#include <vector>
+
+/* -------------------------------------------------------------------------- */
+
+/** Bake the extruded glyphs of a laid out string into a single interleaved
+ * vertex buffer and its index buffer, to be drawn at once.
+ * Each glyph occurrence gives its front, back and edge vertices in that order,
+ * transformed by its placement, the back being its face pushed back by the
+ * extrusion. Rebuilding keeps the indices while the layout and the glyphs
+ * topology are unchanged, and only rewrites the vertices of the occurrences
+ * which have changed. */
+class TextMeshBuilder {
+ public:
+  enum Part_t {
+    kFront,
+    kEdge,
+    kBack,
+    kNumParts
+  };
+
+  struct Vertex_t {
+    float x;
+    float y;
+    float z;
+    float r;
+    float g;
+    float b;
+    float a;
+  };
+
+  /* Geometry of a glyph, shared by its occurrences. Vertices are read stride
+   * floats apart. The edge vertices alternate between the front and the back,
+   * their z coordinate being scaled by the extrusion. */
+  struct Source_t {
+    const float *face_vertices = nullptr;
+    int num_face_vertices = 0;
+    const uint32_t *face_indices = nullptr;
+    int num_face_indices = 0;
+    const float *edge_vertices = nullptr;
+    int num_edge_vertices = 0;
+    const uint32_t *edge_indices = nullptr;
+    int num_edge_indices = 0;
+    int stride = 3;
+    uint32_t topology = 0u;   // changed whenever the indices are.
+    uint64_t revision = 0u;   // changed whenever the vertices are.
+  };
+
+  /* Occurrence of a glyph, placed by a row major 3x4 affine transform. */
+  struct Instance_t {
+    const Source_t *source;
+    float transform[12];
+  };
+
+  struct Params_t {
+    float extrusion = 1.0f;
+    float colors[kNumParts][4] = {
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+    };
+  };
+
+  /* Parts of the buffers rewritten by the last build. */
+  struct Changes_t {
+    bool layout = false;      // indices rebuilt, every vertex rewritten.
+    int first_vertex = 0;
+    int num_vertices = 0;
+  };
+
+ public:
+  TextMeshBuilder() = default;
+
+  /* Bake count glyph occurrences, updating the buffers of the previous build
+   * when possible. */
+  Changes_t build(const Instance_t *instances, int count, Params_t const& params);
+
+  /* Release the buffers, the next build rewriting everything. */
+  void clear();
+
+  const std::vector<Vertex_t>& getVertices() const {
+    return vertices_;
+  }
+
+  const std::vector<uint32_t>& getIndices() const {
+    return indices_;
+  }
+
+ private:
+  struct Record_t {
+    uint32_t topology;
+    uint64_t revision;
+    int num_face_vertices;
+    int num_face_indices;
+    int num_edge_vertices;
+    int num_edge_indices;
+    float transform[12];
+    int first_vertex;
+  };
+
+  /* Return true if an occurrence has the same layout as its record. */
+  static bool HasSameLayout(Instance_t const& instance, Record_t const& record);
+
+  /* Write the vertices of an occurrence from its record first vertex. */
+  void writeVertices(Instance_t const& instance, Record_t const& record, Params_t const& params);
+
+  /* Append the indices of an occurrence. */
+  void writeIndices(Instance_t const& instance, Record_t const& record);
+
+  std::vector<Vertex_t> vertices_;
+  std::vector<uint32_t> indices_;
+  std::vector<Record_t> records_;
+  Params_t params_;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_TEXT_MESH_BUILDER_H_
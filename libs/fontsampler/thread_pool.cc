@@ -0,0 +1,190 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/* State shared by the participants of a parallelFor. */
+struct ParallelJob_t {
+  std::atomic<int> next_chunk{0};
+  std::atomic<int> next_participant{1};
+  std::atomic<int> num_done{0};
+  int num_chunks = 0;
+  int count = 0;
+  int grain = 1;
+  const ThreadPool::RangeFunc_t *fn = nullptr;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+
+  /* Process chunks until none are left. */
+  void process(int participant) {
+    int chunk;
+    while ((chunk = next_chunk.fetch_add(1)) < num_chunks) {
+      const int begin = chunk * grain;
+      const int end = std::min(begin + grain, count);
+      (*fn)(begin, end, participant);
+
+      if (num_done.fetch_add(1) + 1 == num_chunks) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_all();
+      }
+    }
+  }
+};
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+ThreadPool::ThreadPool(int num_threads)
+{
+  if (num_threads < 0) {
+    num_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+  }
+
+  queues_.resize(num_threads);
+  for (auto &q : queues_) {
+    q = std::make_unique<Queue_t>();
+  }
+
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto &t : threads_) {
+    t.join();
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ThreadPool::submit(Task_t task)
+{
+  // Without workers the task is run immediately.
+  if (threads_.empty()) {
+    task();
+    return;
+  }
+
+  const unsigned int index = next_queue_.fetch_add(1u) % queues_.size();
+  {
+    auto &q = *queues_[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_pending_;
+  }
+  cv_.notify_one();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ThreadPool::parallelFor(int count, int grain, const RangeFunc_t &fn)
+{
+  if (count <= 0) {
+    return;
+  }
+  grain = std::max(grain, 1);
+
+  const int num_chunks = (count + grain - 1) / grain;
+  if ((num_chunks == 1) || threads_.empty()) {
+    fn(0, count, 0);
+    return;
+  }
+
+  // The job outlives the call for helpers starting after every chunk is done.
+  auto job = std::make_shared<ParallelJob_t>();
+  job->num_chunks = num_chunks;
+  job->count = count;
+  job->grain = grain;
+  job->fn = &fn;
+
+  const int num_helpers = std::min(num_chunks - 1, getNumThreads());
+  for (int i = 0; i < num_helpers; ++i) {
+    submit([job]() {
+      job->process(job->next_participant.fetch_add(1));
+    });
+  }
+
+  // The calling thread takes part, so the job completes even when every
+  // worker is busy.
+  job->process(0);
+
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->cv.wait(lock, [&job]() { return job->num_done.load() == job->num_chunks; });
+}
+
+/* -------------------------------------------------------------------------- */
+
+ThreadPool& ThreadPool::Shared()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ThreadPool::run(int worker)
+{
+  Task_t task;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stop_ || (num_pending_.load() > 0); });
+      if (stop_ && (num_pending_.load() == 0)) {
+        return;
+      }
+    }
+
+    if (pop(worker, task)) {
+      task();
+      task = nullptr;
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ThreadPool::pop(int worker, Task_t &task)
+{
+  const int num_queues = static_cast<int>(queues_.size());
+
+  // Own queue first (most recent task), then steal the oldest from others.
+  for (int i = 0; i < num_queues; ++i) {
+    auto &q = *queues_[(worker + i) % num_queues];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    } else {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    }
+    --num_pending_;
+    return true;
+  }
+
+  return false;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,81 @@
+#ifndef FONTSAMPLER_THREAD_POOL_H_
+#define FONTSAMPLER_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* -------------------------------------------------------------------------- */
+
+/** Work-stealing pool of worker threads.
+ * Each worker owns a queue of tasks and steals from the others when its own
+ * is empty. parallelFor splits a range in chunks processed both by the
+ * workers and the calling thread, so it can safely be nested or called
+ * from several threads at once. */
+class ThreadPool {
+ public:
+  using Task_t = std::function<void()>;
+
+  /* Callback processing the range [begin, end) of a parallelFor.
+   * participant is unique among the concurrent calls of the same
+   * parallelFor and lower than getConcurrency(), so it can index
+   * per-thread scratch buffers. */
+  using RangeFunc_t = std::function<void(int begin, int end, int participant)>;
+
+  /* Create a pool with num_threads workers, or one less than the number
+   * of hardware threads when num_threads is negative. */
+  explicit ThreadPool(int num_threads = -1);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int getNumThreads() const {
+    return static_cast<int>(threads_.size());
+  }
+
+  /* Maximum number of participants to a parallelFor. */
+  int getConcurrency() const {
+    return getNumThreads() + 1;
+  }
+
+  /* Queue a task to be run asynchronously by a worker. */
+  void submit(Task_t task);
+
+  /* Process [0, count) by chunks of grain indices and returns when
+   * all of them are done. */
+  void parallelFor(int count, int grain, const RangeFunc_t &fn);
+
+  /* Process-wide pool. */
+  static ThreadPool& Shared();
+
+ private:
+  struct Queue_t {
+    std::mutex mutex;
+    std::deque<Task_t> tasks;
+  };
+
+  /* Worker loop. */
+  void run(int worker);
+
+  /* Pop a task from the worker own queue, or steal one from another. */
+  bool pop(int worker, Task_t &task);
+
+  std::vector<std::thread> threads_;
+  std::vector<std::unique_ptr<Queue_t>> queues_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<int> num_pending_{0};
+  std::atomic<unsigned int> next_queue_{0u};
+  bool stop_ = false;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_THREAD_POOL_H_
@@ -0,0 +1,779 @@
+#include "triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/* Contours with more points than this are z-order hashed. */
+constexpr int kHashingThreshold = 80;
+
+/* Twice the signed area of the triangle pqr, negative when counterclockwise. */
+template<typename T>
+inline float Area(const T &p, const T &q, const T &r) {
+  return (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+}
+
+template<typename T>
+inline bool Equals(const T &a, const T &b) {
+  return (a.x == b.x) && (a.y == b.y);
+}
+
+inline int Sign(float v) {
+  return (v > 0.0f) ? 1 : (v < 0.0f) ? -1 : 0;
+}
+
+inline bool PointInTriangle(float ax, float ay, float bx, float by, float cx, float cy, float px, float py) {
+  return ((cx - px) * (ay - py) >= (ax - px) * (cy - py))
+      && ((ax - px) * (by - py) >= (bx - px) * (ay - py))
+      && ((bx - px) * (cy - py) >= (cx - px) * (by - py));
+}
+
+/* Check if q lies on the segment pr, knowing the three points are collinear. */
+template<typename T>
+inline bool OnSegment(const T &p, const T &q, const T &r) {
+  return (q.x <= std::max(p.x, r.x)) && (q.x >= std::min(p.x, r.x))
+      && (q.y <= std::max(p.y, r.y)) && (q.y >= std::min(p.y, r.y));
+}
+
+template<typename T>
+inline bool Intersects(const T &p1, const T &q1, const T &p2, const T &q2) {
+  const int o1 = Sign(Area(p1, q1, p2));
+  const int o2 = Sign(Area(p1, q1, q2));
+  const int o3 = Sign(Area(p2, q2, p1));
+  const int o4 = Sign(Area(p2, q2, q1));
+
+  return ((o1 != o2) && (o3 != o4))
+      || ((o1 == 0) && OnSegment(p1, p2, q1))
+      || ((o2 == 0) && OnSegment(p1, q2, q1))
+      || ((o3 == 0) && OnSegment(p2, p1, q2))
+      || ((o4 == 0) && OnSegment(p2, q1, q2));
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::triangulate(const float *xy, int stride, int num_points, const int *segments, int num_segments, std::vector<uint32_t> &indices)
+{
+  indices.clear();
+  indices_ = &indices;
+  xy_ = xy;
+  stride_ = stride;
+
+  // Reconstruct the contours from their segments.
+  next_point_.assign(num_points, -1);
+  visited_.assign(num_points, 0u);
+  for (int i = 0; i < num_segments; ++i) {
+    const int a = segments[2*i + 0];
+    const int b = segments[2*i + 1];
+    if ((a < 0) || (a >= num_points) || (b < 0) || (b >= num_points)) {
+      return false;
+    }
+    next_point_[a] = b;
+  }
+
+  contours_.clear();
+  contour_points_.clear();
+  for (int i = 0; i < num_segments; ++i) {
+    const int start = segments[2*i];
+    if (visited_[start]) {
+      continue;
+    }
+
+    Contour_t c;
+    c.first = static_cast<int>(contour_points_.size());
+    c.area = 0.0f;
+    c.min_x = c.min_y = +HUGE_VALF;
+    c.max_x = c.max_y = -HUGE_VALF;
+    c.depth = 0;
+    c.parent = -1;
+
+    int p = start;
+    do {
+      if ((p < 0) || visited_[p]) {
+        return false;
+      }
+      visited_[p] = 1u;
+      contour_points_.push_back(p);
+
+      const float *v = xy + p * stride;
+      const int q = next_point_[p];
+      if (q >= 0) {
+        const float *w = xy + q * stride;
+        c.area += v[0] * w[1] - w[0] * v[1];
+      }
+      c.min_x = std::min(c.min_x, v[0]);
+      c.min_y = std::min(c.min_y, v[1]);
+      c.max_x = std::max(c.max_x, v[0]);
+      c.max_y = std::max(c.max_y, v[1]);
+      p = q;
+    } while (p != start);
+
+    c.count = static_cast<int>(contour_points_.size()) - c.first;
+    c.area *= 0.5f;
+    if (c.count >= 3) {
+      contours_.push_back(c);
+    } else {
+      contour_points_.resize(c.first);
+    }
+  }
+
+  // Nest the contours, the innermost enclosing contour being the parent.
+  const int num_contours = static_cast<int>(contours_.size());
+  for (int i = 0; i < num_contours; ++i) {
+    auto &c = contours_[i];
+    const float *v = xy + contour_points_[c.first] * stride;
+    const float px = v[0];
+    const float py = v[1];
+
+    for (int j = 0; j < num_contours; ++j) {
+      const auto &o = contours_[j];
+      if ((i == j) || (px < o.min_x) || (px > o.max_x) || (py < o.min_y) || (py > o.max_y)) {
+        continue;
+      }
+
+      bool inside = false;
+      for (int k = 0; k < o.count; ++k) {
+        const float *a = xy + contour_points_[o.first + k] * stride;
+        const float *b = xy + contour_points_[o.first + (k + 1) % o.count] * stride;
+        if (((a[1] > py) != (b[1] > py))
+         && (px < (b[0] - a[0]) * (py - a[1]) / (b[1] - a[1]) + a[0])) {
+          inside = !inside;
+        }
+      }
+      if (inside) {
+        c.depth += 1;
+        if ((c.parent < 0) || (fabsf(o.area) < fabsf(contours_[c.parent].area))) {
+          c.parent = j;
+        }
+      }
+    }
+  }
+
+  // Triangulate each outer contour with its holes.
+  nodes_.clear();
+  nodes_.reserve(3 * num_points + 8);
+  for (int i = 0; i < num_contours; ++i) {
+    const auto &c = contours_[i];
+    if (c.depth & 1) {
+      continue;
+    }
+
+    int outer_node = linkContour(c, true);
+    if ((outer_node < 0) || (nodes_[outer_node].next == nodes_[outer_node].prev)) {
+      continue;
+    }
+    outer_node = eliminateHoles(outer_node, i);
+
+    // Hash the nodes of large polygons.
+    int num_nodes = c.count;
+    min_x_ = c.min_x;
+    min_y_ = c.min_y;
+    for (const auto &h : contours_) {
+      num_nodes += (h.parent == i) && (h.depth & 1) ? h.count : 0;
+    }
+    use_hashing_ = (num_nodes > kHashingThreshold);
+    if (use_hashing_) {
+      const float size = std::max(c.max_x - c.min_x, c.max_y - c.min_y);
+      inv_size_ = (size > 0.0f) ? 32767.0f / size : 0.0f;
+      use_hashing_ = (inv_size_ > 0.0f);
+    }
+
+    earcutLinked(outer_node, 0);
+  }
+
+  indices_ = nullptr;
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::linkContour(const Contour_t &contour, bool counterclockwise)
+{
+  int last = -1;
+  if (counterclockwise == (contour.area > 0.0f)) {
+    for (int i = 0; i < contour.count; ++i) {
+      const int index = contour_points_[contour.first + i];
+      last = insertNode(index, xy_[index * stride_], xy_[index * stride_ + 1], last);
+    }
+  } else {
+    for (int i = contour.count - 1; i >= 0; --i) {
+      const int index = contour_points_[contour.first + i];
+      last = insertNode(index, xy_[index * stride_], xy_[index * stride_ + 1], last);
+    }
+  }
+
+  if ((last >= 0) && Equals(nodes_[last], nodes_[nodes_[last].next])) {
+    removeNode(last);
+    last = nodes_[last].next;
+  }
+  return last;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::eliminateHoles(int outer_node, int outer_index)
+{
+  // Link every hole and bridge them from the leftmost.
+  hole_nodes_.clear();
+  for (const auto &h : contours_) {
+    if ((h.parent != outer_index) || !(h.depth & 1)) {
+      continue;
+    }
+    const int start = linkContour(h, false);
+    if (start < 0) {
+      continue;
+    }
+    int leftmost = start;
+    int p = start;
+    do {
+      const auto &n = nodes_[p];
+      const auto &l = nodes_[leftmost];
+      if ((n.x < l.x) || ((n.x == l.x) && (n.y < l.y))) {
+        leftmost = p;
+      }
+      p = n.next;
+    } while (p != start);
+    hole_nodes_.push_back(leftmost);
+  }
+
+  std::sort(hole_nodes_.begin(), hole_nodes_.end(), [this](int a, int b) {
+    const auto &na = nodes_[a];
+    const auto &nb = nodes_[b];
+    return (na.x != nb.x) ? (na.x < nb.x) : (na.y < nb.y);
+  });
+
+  for (const int hole : hole_nodes_) {
+    const int bridge = findHoleBridge(hole, outer_node);
+    if (bridge < 0) {
+      continue;
+    }
+    const int bridge_reverse = splitPolygon(bridge, hole);
+    filterPoints(bridge_reverse, nodes_[bridge_reverse].next);
+    outer_node = filterPoints(bridge, nodes_[bridge].next);
+  }
+
+  return outer_node;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::findHoleBridge(int hole, int outer_node)
+{
+  const float hx = nodes_[hole].x;
+  const float hy = nodes_[hole].y;
+
+  // Find the segment of the outer ring crossed by a ray from the hole point
+  // to the left, closest to it.
+  float qx = -HUGE_VALF;
+  int m = -1;
+  int p = outer_node;
+  do {
+    const auto &a = nodes_[p];
+    const auto &b = nodes_[a.next];
+    if ((hy <= a.y) && (hy >= b.y) && (b.y != a.y)) {
+      const float x = a.x + (hy - a.y) * (b.x - a.x) / (b.y - a.y);
+      if ((x <= hx) && (x > qx)) {
+        qx = x;
+        m = (a.x < b.x) ? p : a.next;
+        if (x == hx) {
+          // The hole touches the outer segment.
+          return m;
+        }
+      }
+    }
+    p = a.next;
+  } while (p != outer_node);
+
+  if (m < 0) {
+    return -1;
+  }
+
+  // Look for points inside the triangle formed by the hole point, the
+  // crossing point and the segment endpoint, picking the one with the
+  // smallest angle to the ray if any.
+  const int stop = m;
+  const float mx = nodes_[m].x;
+  const float my = nodes_[m].y;
+  float tan_min = HUGE_VALF;
+
+  p = m;
+  do {
+    const auto &n = nodes_[p];
+    if ((hx >= n.x) && (n.x >= mx) && (hx != n.x)
+     && PointInTriangle((hy < my) ? hx : qx, hy, mx, my, (hy < my) ? qx : hx, hy, n.x, n.y)) {
+      const float tan = fabsf(hy - n.y) / (hx - n.x);
+      if (locallyInside(p, hole)
+       && ((tan < tan_min)
+        || ((tan == tan_min) && ((n.x > nodes_[m].x) || ((n.x == nodes_[m].x) && sectorContainsSector(m, p)))))) {
+        m = p;
+        tan_min = tan;
+      }
+    }
+    p = n.next;
+  } while (p != stop);
+
+  return m;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Triangulator::earcutLinked(int ear, int pass)
+{
+  if (ear < 0) {
+    return;
+  }
+
+  if ((0 == pass) && use_hashing_) {
+    indexCurve(ear);
+  }
+
+  int stop = ear;
+  while (nodes_[ear].prev != nodes_[ear].next) {
+    const int prev = nodes_[ear].prev;
+    const int next = nodes_[ear].next;
+
+    if (use_hashing_ ? isEarHashed(ear) : isEar(ear)) {
+      emitTriangle(prev, ear, next);
+      removeNode(ear);
+
+      // Skipping the next vertex leads to less sliver triangles.
+      ear = nodes_[next].next;
+      stop = ear;
+      continue;
+    }
+
+    ear = next;
+
+    // When no ear was found over a whole loop, try harder.
+    if (ear == stop) {
+      if (0 == pass) {
+        earcutLinked(filterPoints(ear), 1);
+      } else if (1 == pass) {
+        ear = cureLocalIntersections(filterPoints(ear));
+        earcutLinked(ear, 2);
+      } else {
+        splitEarcut(ear);
+      }
+      break;
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::isEar(int ear) const
+{
+  const auto &a = nodes_[nodes_[ear].prev];
+  const auto &b = nodes_[ear];
+  const auto &c = nodes_[b.next];
+
+  // Reflex vertex.
+  if (Area(a, b, c) >= 0.0f) {
+    return false;
+  }
+
+  const float x0 = std::min({a.x, b.x, c.x});
+  const float y0 = std::min({a.y, b.y, c.y});
+  const float x1 = std::max({a.x, b.x, c.x});
+  const float y1 = std::max({a.y, b.y, c.y});
+
+  // No other point should lie inside the ear.
+  for (int p = c.next; p != b.prev; p = nodes_[p].next) {
+    const auto &n = nodes_[p];
+    if ((n.x >= x0) && (n.x <= x1) && (n.y >= y0) && (n.y <= y1)
+     && PointInTriangle(a.x, a.y, b.x, b.y, c.x, c.y, n.x, n.y)
+     && (Area(nodes_[n.prev], n, nodes_[n.next]) >= 0.0f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::isEarHashed(int ear) const
+{
+  const int ia = nodes_[ear].prev;
+  const int ic = nodes_[ear].next;
+  const auto &a = nodes_[ia];
+  const auto &b = nodes_[ear];
+  const auto &c = nodes_[ic];
+
+  if (Area(a, b, c) >= 0.0f) {
+    return false;
+  }
+
+  const float x0 = std::min({a.x, b.x, c.x});
+  const float y0 = std::min({a.y, b.y, c.y});
+  const float x1 = std::max({a.x, b.x, c.x});
+  const float y1 = std::max({a.y, b.y, c.y});
+
+  // Only visit the nodes whose z-order is within the ear bounding box.
+  const int32_t min_z = zOrder(x0, y0);
+  const int32_t max_z = zOrder(x1, y1);
+
+  auto blocks = [&](int p) {
+    const auto &n = nodes_[p];
+    return (n.x >= x0) && (n.x <= x1) && (n.y >= y0) && (n.y <= y1)
+        && (p != ia) && (p != ic)
+        && PointInTriangle(a.x, a.y, b.x, b.y, c.x, c.y, n.x, n.y)
+        && (Area(nodes_[n.prev], n, nodes_[n.next]) >= 0.0f);
+  };
+
+  int p = b.prev_z;
+  int n = b.next_z;
+  while ((p >= 0) && (nodes_[p].z >= min_z) && (n >= 0) && (nodes_[n].z <= max_z)) {
+    if (blocks(p)) {
+      return false;
+    }
+    p = nodes_[p].prev_z;
+    if (blocks(n)) {
+      return false;
+    }
+    n = nodes_[n].next_z;
+  }
+  while ((p >= 0) && (nodes_[p].z >= min_z)) {
+    if (blocks(p)) {
+      return false;
+    }
+    p = nodes_[p].prev_z;
+  }
+  while ((n >= 0) && (nodes_[n].z <= max_z)) {
+    if (blocks(n)) {
+      return false;
+    }
+    n = nodes_[n].next_z;
+  }
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::filterPoints(int start, int end)
+{
+  if (start < 0) {
+    return start;
+  }
+  if (end < 0) {
+    end = start;
+  }
+
+  int p = start;
+  bool again;
+  do {
+    again = false;
+    const auto &n = nodes_[p];
+    if (Equals(n, nodes_[n.next]) || (Area(nodes_[n.prev], n, nodes_[n.next]) == 0.0f)) {
+      removeNode(p);
+      p = end = nodes_[p].prev;
+      if (p == nodes_[p].next) {
+        break;
+      }
+      again = true;
+    } else {
+      p = n.next;
+    }
+  } while (again || (p != end));
+
+  return end;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::cureLocalIntersections(int start)
+{
+  int p = start;
+  do {
+    const int a = nodes_[p].prev;
+    const int p_next = nodes_[p].next;
+    const int b = nodes_[p_next].next;
+
+    if (!Equals(nodes_[a], nodes_[b])
+     && Intersects(nodes_[a], nodes_[p], nodes_[p_next], nodes_[b])
+     && locallyInside(a, b)
+     && locallyInside(b, a)) {
+      emitTriangle(a, p, b);
+      removeNode(p);
+      removeNode(p_next);
+      p = start = b;
+    }
+    p = nodes_[p].next;
+  } while (p != start);
+
+  return filterPoints(p);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Triangulator::splitEarcut(int start)
+{
+  int a = start;
+  do {
+    int b = nodes_[nodes_[a].next].next;
+    while (b != nodes_[a].prev) {
+      if ((nodes_[a].index != nodes_[b].index) && isValidDiagonal(a, b)) {
+        int c = splitPolygon(a, b);
+        a = filterPoints(a, nodes_[a].next);
+        c = filterPoints(c, nodes_[c].next);
+        earcutLinked(a, 0);
+        earcutLinked(c, 0);
+        return;
+      }
+      b = nodes_[b].next;
+    }
+    a = nodes_[a].next;
+  } while (a != start);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::splitPolygon(int a, int b)
+{
+  const int a2 = static_cast<int>(nodes_.size());
+  const int b2 = a2 + 1;
+  nodes_.push_back(nodes_[a]);
+  nodes_.push_back(nodes_[b]);
+
+  const int an = nodes_[a].next;
+  const int bp = nodes_[b].prev;
+
+  nodes_[a].next = b;
+  nodes_[b].prev = a;
+
+  nodes_[a2].next = an;
+  nodes_[an].prev = a2;
+
+  nodes_[b2].next = a2;
+  nodes_[a2].prev = b2;
+
+  nodes_[bp].next = b2;
+  nodes_[b2].prev = bp;
+
+  // The copies are not part of the z-order list.
+  nodes_[a2].prev_z = nodes_[a2].next_z = -1;
+  nodes_[b2].prev_z = nodes_[b2].next_z = -1;
+
+  return b2;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::isValidDiagonal(int a, int b) const
+{
+  const auto &na = nodes_[a];
+  const auto &nb = nodes_[b];
+
+  // The diagonal must not touch the polygon edges, and lie inside it
+  // without creating a degenerate split.
+  if ((nodes_[na.next].index == nb.index) || (nodes_[na.prev].index == nb.index) || intersectsPolygon(a, b)) {
+    return false;
+  }
+  if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+   && ((Area(nodes_[na.prev], na, nodes_[nb.prev]) != 0.0f) || (Area(na, nodes_[nb.prev], nb) != 0.0f))) {
+    return true;
+  }
+  // Special zero-length case.
+  return Equals(na, nb)
+      && (Area(nodes_[na.prev], na, nodes_[na.next]) > 0.0f)
+      && (Area(nodes_[nb.prev], nb, nodes_[nb.next]) > 0.0f);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::intersectsPolygon(int a, int b) const
+{
+  const int ia = nodes_[a].index;
+  const int ib = nodes_[b].index;
+  int p = a;
+  do {
+    const auto &n = nodes_[p];
+    const auto &next = nodes_[n.next];
+    if ((n.index != ia) && (next.index != ia) && (n.index != ib) && (next.index != ib)
+     && Intersects(n, next, nodes_[a], nodes_[b])) {
+      return true;
+    }
+    p = n.next;
+  } while (p != a);
+  return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::locallyInside(int a, int b) const
+{
+  const auto &na = nodes_[a];
+  const auto &nb = nodes_[b];
+  const auto &prev = nodes_[na.prev];
+  const auto &next = nodes_[na.next];
+
+  return (Area(prev, na, next) < 0.0f)
+          ? (Area(na, nb, next) >= 0.0f) && (Area(na, prev, nb) >= 0.0f)
+          : (Area(na, nb, prev) < 0.0f) || (Area(na, next, nb) < 0.0f);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::middleInside(int a, int b) const
+{
+  const float px = 0.5f * (nodes_[a].x + nodes_[b].x);
+  const float py = 0.5f * (nodes_[a].y + nodes_[b].y);
+
+  bool inside = false;
+  int p = a;
+  do {
+    const auto &n = nodes_[p];
+    const auto &next = nodes_[n.next];
+    if (((n.y > py) != (next.y > py)) && (next.y != n.y)
+     && (px < (next.x - n.x) * (py - n.y) / (next.y - n.y) + n.x)) {
+      inside = !inside;
+    }
+    p = n.next;
+  } while (p != a);
+  return inside;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Triangulator::sectorContainsSector(int m, int p) const
+{
+  const auto &nm = nodes_[m];
+  const auto &np = nodes_[p];
+  return (Area(nodes_[nm.prev], nm, nodes_[np.prev]) < 0.0f)
+      && (Area(nodes_[np.next], nm, nodes_[nm.next]) < 0.0f);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Triangulator::indexCurve(int start)
+{
+  int p = start;
+  do {
+    auto &n = nodes_[p];
+    n.z = zOrder(n.x, n.y);
+    n.prev_z = n.prev;
+    n.next_z = n.next;
+    p = n.next;
+  } while (p != start);
+
+  nodes_[nodes_[p].prev_z].next_z = -1;
+  nodes_[p].prev_z = -1;
+
+  // Merge sort of the z-order list, by Simon Tatham.
+  int list = p;
+  int num_merges;
+  int in_size = 1;
+  do {
+    p = list;
+    list = -1;
+    int tail = -1;
+    num_merges = 0;
+
+    while (p >= 0) {
+      ++num_merges;
+      int q = p;
+      int p_size = 0;
+      for (int i = 0; i < in_size; ++i) {
+        ++p_size;
+        q = nodes_[q].next_z;
+        if (q < 0) {
+          break;
+        }
+      }
+      int q_size = in_size;
+
+      while ((p_size > 0) || ((q_size > 0) && (q >= 0))) {
+        int e;
+        if ((p_size != 0) && ((q_size == 0) || (q < 0) || (nodes_[p].z <= nodes_[q].z))) {
+          e = p;
+          p = nodes_[p].next_z;
+          --p_size;
+        } else {
+          e = q;
+          q = nodes_[q].next_z;
+          --q_size;
+        }
+
+        if (tail >= 0) {
+          nodes_[tail].next_z = e;
+        } else {
+          list = e;
+        }
+        nodes_[e].prev_z = tail;
+        tail = e;
+      }
+      p = q;
+    }
+
+    nodes_[tail].next_z = -1;
+    in_size *= 2;
+  } while (num_merges > 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int32_t Triangulator::zOrder(float fx, float fy) const
+{
+  // Interleave the bits of the coordinates, scaled to 15 bits.
+  int32_t x = static_cast<int32_t>((fx - min_x_) * inv_size_);
+  int32_t y = static_cast<int32_t>((fy - min_y_) * inv_size_);
+
+  x = (x | (x << 8)) & 0x00FF00FF;
+  x = (x | (x << 4)) & 0x0F0F0F0F;
+  x = (x | (x << 2)) & 0x33333333;
+  x = (x | (x << 1)) & 0x55555555;
+
+  y = (y | (y << 8)) & 0x00FF00FF;
+  y = (y | (y << 4)) & 0x0F0F0F0F;
+  y = (y | (y << 2)) & 0x33333333;
+  y = (y | (y << 1)) & 0x55555555;
+
+  return x | (y << 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Triangulator::insertNode(int index, float x, float y, int last)
+{
+  const int p = static_cast<int>(nodes_.size());
+  nodes_.push_back({ index, x, y, p, p, 0, -1, -1 });
+
+  if (last >= 0) {
+    const int next = nodes_[last].next;
+    nodes_[p].next = next;
+    nodes_[p].prev = last;
+    nodes_[next].prev = p;
+    nodes_[last].next = p;
+  }
+  return p;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Triangulator::removeNode(int p)
+{
+  const auto &n = nodes_[p];
+  nodes_[n.next].prev = n.prev;
+  nodes_[n.prev].next = n.next;
+
+  if (n.prev_z >= 0) {
+    nodes_[n.prev_z].next_z = n.next_z;
+  }
+  if (n.next_z >= 0) {
+    nodes_[n.next_z].prev_z = n.prev_z;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Triangulator::emitTriangle(int a, int b, int c)
+{
+  indices_->push_back(static_cast<uint32_t>(nodes_[a].index));
+  indices_->push_back(static_cast<uint32_t>(nodes_[b].index));
+  indices_->push_back(static_cast<uint32_t>(nodes_[c].index));
+}
+
+/* -------------------------------------------------------------------------- */
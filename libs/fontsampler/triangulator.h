@@ -0,0 +1,112 @@
+#ifndef FONTSAMPLER_TRIANGULATOR_H_
+#define FONTSAMPLER_TRIANGULATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+/* -------------------------------------------------------------------------- */
+
+/** Ear clipping triangulator of polygons with holes.
+ * Closed contours are given as segments between points, as extracted from
+ * sampled glyph paths. Contours nested an odd number of times are holes,
+ * bridged to their enclosing contour before clipping its ears. Large contours
+ * index their vertices along a z-order curve to speed up the ear tests.
+ * Working buffers are kept between calls so no allocation happens once they
+ * have grown to the largest polygon. */
+class Triangulator {
+ public:
+  Triangulator() = default;
+
+  /* Triangulate the polygon whose contour segments are num_segments pairs of
+   * point indices. Point coordinates are read stride floats apart from xy.
+   * Triangles are written to indices as triplets of point indices.
+   * @return false if a contour is not closed. */
+  bool triangulate(const float *xy, int stride, int num_points, const int *segments, int num_segments, std::vector<uint32_t> &indices);
+
+ private:
+  struct Node_t {
+    int index;      // point index.
+    float x;
+    float y;
+    int prev;
+    int next;
+    int32_t z;      // z-order of the node, when hashed.
+    int prev_z;
+    int next_z;
+  };
+
+  struct Contour_t {
+    int first;      // offset in contour_points_.
+    int count;
+    float area;     // signed area, positive counterclockwise.
+    float min_x, min_y, max_x, max_y;
+    int depth;      // number of enclosing contours.
+    int parent;     // innermost enclosing contour, -1 if none.
+  };
+
+  /* Link the points of a contour into a ring of the given orientation, and
+   * return its last node. */
+  int linkContour(const Contour_t &contour, bool counterclockwise);
+
+  /* Bridge the holes of an outer ring into it. */
+  int eliminateHoles(int outer_node, int outer_index);
+
+  /* Find the node of the outer ring to bridge a hole node to. */
+  int findHoleBridge(int hole, int outer_node);
+
+  /* Main ear clipping loop. */
+  void earcutLinked(int ear, int pass);
+
+  bool isEar(int ear) const;
+  bool isEarHashed(int ear) const;
+
+  /* Remove duplicate and collinear points from a ring. */
+  int filterPoints(int start, int end = -1);
+
+  /* Clip local self-intersections, emitting their triangles. */
+  int cureLocalIntersections(int start);
+
+  /* Split the ring along a valid diagonal and triangulate both halves. */
+  void splitEarcut(int start);
+
+  /* Link a new ring from a to b, and return the node duplicated from b. */
+  int splitPolygon(int a, int b);
+
+  bool isValidDiagonal(int a, int b) const;
+  bool intersectsPolygon(int a, int b) const;
+  bool locallyInside(int a, int b) const;
+  bool middleInside(int a, int b) const;
+  bool sectorContainsSector(int m, int p) const;
+
+  /* Sort the ring nodes by z-order. */
+  void indexCurve(int start);
+  int32_t zOrder(float x, float y) const;
+
+  int insertNode(int index, float x, float y, int last);
+  void removeNode(int n);
+
+  void emitTriangle(int a, int b, int c);
+
+  std::vector<Node_t> nodes_;
+  std::vector<uint32_t> *indices_ = nullptr;
+
+  // Contours reconstructed from the segments.
+  std::vector<int> next_point_;
+  std::vector<uint8_t> visited_;
+  std::vector<Contour_t> contours_;
+  std::vector<int> contour_points_;
+  std::vector<int> hole_nodes_;
+
+  const float *xy_ = nullptr;
+  int stride_ = 2;
+
+  // Bounds used for the z-order hashing, when enabled.
+  bool use_hashing_ = false;
+  float min_x_ = 0.0f;
+  float min_y_ = 0.0f;
+  float inv_size_ = 0.0f;
+};
+
+/* -------------------------------------------------------------------------- */
+
+#endif // FONTSAMPLER_TRIANGULATOR_H_
@@ -1,10 +1,13 @@
 #include "ttf_reader.h"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
 
+#include "thread_pool.h"
+
 /* -------------------------------------------------------------------------- */
 
 /**
@@ -40,9 +43,20 @@ void ConvertEndianness(T &n) {
   n = ENDIANNESS(n);
 }
 
+/* Swap in fixed size blocks, which compilers vectorize without needing
+ * a cost model allowing a runtime trip count (eg. gcc -O2). */
 template<typename T>
 void ConvertEndiannessArray(T *const v, const size_t size) {
-  for (size_t i=0u; i<size; ++i) {
+  constexpr size_t kBlockSize = 32u / sizeof(T);
+
+  size_t i = 0u;
+  for (; i + kBlockSize <= size; i += kBlockSize) {
+    T *const block = v + i;
+    for (size_t j = 0u; j < kBlockSize; ++j) {
+      ConvertEndianness(block[j]);
+    }
+  }
+  for (; i < size; ++i) {
     ConvertEndianness(v[i]);
   }
 }
@@ -62,24 +76,37 @@ void ConvertTableHeaderEndianness(TableHeader_t &th) {
   ConvertEndianness(th.length);
 }
 
-/* Calculate a table checksum. */
-uint32_t CalculateTableChecksum(uint32_t *table, const uint32_t table_size) {
-  uint32_t sum = 0u;
-  uint32_t nLongs = (table_size + 3u) / 4u;
-  while (nLongs-- > 0u) {
-    sum += *table++;
+/* Calculate the checksum of a table chunk, the sum of its big-endian 32-bit
+ * words, the last one padded with zeros. The chunk must start on a word.
+ * Being the sum of the bytes at each position in a word, shifted, it is
+ * summed per byte over fixed size blocks, which compilers vectorize. */
+uint32_t CalculateChecksum(const uint8_t *data, const uint32_t size) {
+  constexpr uint32_t kBlockSize = 64u;
+
+  uint32_t lanes[kBlockSize] = {};
+  uint32_t i = 0u;
+  for (; i + kBlockSize <= size; i += kBlockSize) {
+    const uint8_t *block = data + i;
+    for (uint32_t j = 0u; j < kBlockSize; ++j) {
+      lanes[j] += block[j];
+    }
+  }
+
+  uint32_t bytes[4u] = {};
+  for (uint32_t j = 0u; j < kBlockSize; ++j) {
+    bytes[j & 3u] += lanes[j];
+  }
+  for (; i < size; ++i) {
+    bytes[i & 3u] += data[i];
   }
-  return sum;
+
+  return (bytes[0u] << 24u) + (bytes[1u] << 16u) + (bytes[2u] << 8u) + bytes[3u];
 }
 
 /* Transform a TTF table tag 'word' to a string. */
 void TagWordToStr(uint32_t n, char t[5]) {
-  union {
-    char b[4];
-    uint32_t n;
-  } word;
-  word.n = n;
-  sprintf(t, "%s", word.b);
+  // [the tag keeps the file bytes order]
+  memcpy(t, &n, 4u);
   t[4] = '\0'; 
 }
 
@@ -100,20 +127,9 @@ void TTFReader::clear() {
   }
   tables_.clear();
 
-  delete [] cmap_.format4.endCode;
-  delete [] cmap_.format4.startCode;
-  delete [] cmap_.format4.idDelta;
-  delete [] cmap_.format4.idRangeOffset;
-  delete [] cmap_.format4.glyphIndexArray;
-  memset(&cmap_.format4, sizeof(cmap_.format4), 0);
-
-  if (loca_.offset_u16) {
-    delete [] loca_.offset_u16;
-    loca_.offset_u16 = nullptr;
-  } else if (loca_.offset_u32) {
-    delete [] loca_.offset_u32;
-    loca_.offset_u32 = nullptr;
-  }
+  // The views pointed into the tables.
+  cmap_.format4 = {};
+  loca_ = {};
 
   for (auto &g : glyphes_) {
     delete g.second;
@@ -134,9 +150,17 @@ bool TTFReader::read(const char* ttf_filename) {
     return false;
   }
 
+  /* Retrieve the file size to bound the tables. */
+  fseek(fd, 0, SEEK_END);
+  const long filesize = ftell(fd);
+  fseek(fd, 0, SEEK_SET);
+
   /* Read header */
-  size_t nread = fread(&header_, sizeof(header_), 1u, fd);
-  assert(nread == 1u);
+  if (1u != fread(&header_, sizeof(header_), 1u, fd)) {
+    fprintf(stderr, "Error : Invalid header.\n");
+    fclose(fd);
+    return false;
+  }
 
   /* Convert to the architecture endianness */
   ConvertHeaderEndianness(header_);
@@ -153,7 +177,12 @@ bool TTFReader::read(const char* ttf_filename) {
   table_headers_.resize(header_.numTables);
   for (auto& h : table_headers_) {
     // Read table header.
-    fread(&h, sizeof(h), 1u, fd);
+    if (1u != fread(&h, sizeof(h), 1u, fd)) {
+      fprintf(stderr, "Error : Invalid table directory.\n");
+      fclose(fd);
+      clear();
+      return false;
+    }
     // Converts to arch endianness.
     ConvertTableHeaderEndianness(h);
     // Create a table handle.
@@ -162,6 +191,13 @@ bool TTFReader::read(const char* ttf_filename) {
     tables_[h.tag] = table;
   }
 
+  if (tables_.size() != table_headers_.size()) {
+    fprintf(stderr, "Error : Duplicated tables.\n");
+    fclose(fd);
+    clear();
+    return false;
+  }
+
   /* Sort headers by order in file. */
   std::sort(table_headers_.begin(), table_headers_.end(), 
     [](const TableHeader_t &a, const TableHeader_t &b) {
@@ -175,18 +211,30 @@ bool TTFReader::read(const char* ttf_filename) {
     auto &table = tables_[th.tag];
 
     table.head_id = i;
-    table.data = new uint8_t[th.length]();
 
-    ReadOffset(table.data, th.offset, th.length, fd);
+    const bool in_file = (static_cast<uint64_t>(th.offset) + th.length) <= static_cast<uint64_t>(filesize);
+    if (in_file) {
+      table.data = new uint8_t[th.length]();
+    }
+    if (!in_file || !ReadOffset(table.data, th.offset, th.length, fd)) {
+      char tag[5];
+      TagWordToStr(th.tag, tag);
+      fprintf(stderr, "Error : Table '%s' is out of the file.\n", tag);
+      fclose(fd);
+      clear();
+      return false;
+    }
   }
 
   fclose(fd);
 
   /* Perform value checking on the data loaded */ 
-  check_loaded_data();
-
-  /* Reprocess important data  */
-  process_data();
+  if (!check_loaded_data()
+   || (validate_checksums_ && !validate_checksums())
+   || !process_data()) {
+    clear();
+    return false;
+  }
 
   return true;
 }
@@ -205,12 +253,110 @@ glyph_data_t const* const TTFReader::get_glyph_data(uint16_t c) {
 
 /* -------------------------------------------------------------------------- */
 
-void TTFReader::check_loaded_data() const {
-  assert(tables_.find(RequiredTableTAG_t::CMAP) != tables_.end());
-  assert(tables_.find(RequiredTableTAG_t::GLYF) != tables_.end());
-  assert(tables_.find(RequiredTableTAG_t::HEAD) != tables_.end());
-  assert(tables_.find(RequiredTableTAG_t::LOCA) != tables_.end());
-  assert(tables_.find(RequiredTableTAG_t::MAXP) != tables_.end());
+bool TTFReader::check_loaded_data() const {
+  const RequiredTableTAG_t required[] = {
+    RequiredTableTAG_t::CMAP,
+    RequiredTableTAG_t::GLYF,
+    RequiredTableTAG_t::HEAD,
+    RequiredTableTAG_t::LOCA,
+    RequiredTableTAG_t::MAXP,
+  };
+
+  for (auto tag : required) {
+    if (tables_.find(tag) == tables_.end()) {
+      char str[5];
+      TagWordToStr(tag, str);
+      fprintf(stderr, "Error : Missing table '%s'.\n", str);
+      return false;
+    }
+  }
+
+  if (table_length(RequiredTableTAG_t::HEAD) < sizeof(THead_t)
+   || table_length(RequiredTableTAG_t::MAXP) < sizeof(TMaxp_t)) {
+    fprintf(stderr, "Error : Truncated head or maxp table.\n");
+    return false;
+  }
+
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool TTFReader::validate_checksums() const {
+  // Tables are summed per chunk in parallel, a checksum being the sum of its
+  // chunks sums.
+  struct Chunk_t {
+    uint32_t table;
+    uint32_t offset;
+    uint32_t size;
+  };
+  constexpr uint32_t kChunkSize = 64u * 1024u;
+
+  std::vector<Chunk_t> chunks;
+  for (uint32_t i = 0u; i < table_headers_.size(); ++i) {
+    const uint32_t length = table_headers_[i].length;
+    for (uint32_t offset = 0u; offset < length; offset += kChunkSize) {
+      chunks.push_back({i, offset, std::min(kChunkSize, length - offset)});
+    }
+  }
+
+  std::vector<uint32_t> sums(chunks.size());
+  auto process = [&](int begin, int end, int) {
+    for (int i = begin; i < end; ++i) {
+      const auto &chunk = chunks[i];
+      const uint8_t *data = tables_.at(table_headers_[chunk.table].tag).data;
+      sums[i] = CalculateChecksum(data + chunk.offset, chunk.size);
+    }
+  };
+
+  if (checksum_pool_) {
+    checksum_pool_->parallelFor(static_cast<int>(chunks.size()), 1, process);
+  } else {
+    process(0, static_cast<int>(chunks.size()), 0);
+  }
+
+  std::vector<uint32_t> checksums(table_headers_.size(), 0u);
+  for (size_t i = 0u; i < chunks.size(); ++i) {
+    checksums[chunks[i].table] += sums[i];
+  }
+
+  // The head checksum is computed with a null checksum adjustment.
+  const Table_t &head = tables_.at(RequiredTableTAG_t::HEAD);
+  const uint32_t adjustment = BigEndianView_t<uint32_t>(
+    head.data + offsetof(THead_t, checkSumAdjustement), 1u
+  )[0u];
+  checksums[head.head_id] -= adjustment;
+
+  // The font checksum sums the file words, ie. its header, its table
+  // directory and its tables.
+  uint32_t font_checksum = header_.filetype
+                         + ((static_cast<uint32_t>(header_.numTables) << 16u) | header_.searchRange)
+                         + ((static_cast<uint32_t>(header_.entrySelector) << 16u) | header_.rangeShift);
+
+  for (size_t i = 0u; i < table_headers_.size(); ++i) {
+    const auto &th = table_headers_[i];
+
+    if (checksums[i] != th.checksum) {
+      char tag[5];
+      TagWordToStr(th.tag, tag);
+      fprintf(stderr, "Error : Invalid checksum for table '%s'.\n", tag);
+      return false;
+    }
+    font_checksum += ENDIANNESS(th.tag) + th.checksum + th.offset + th.length + checksums[i];
+  }
+
+  if (0xB1B0AFBAu - font_checksum != adjustment) {
+    fprintf(stderr, "Error : Invalid font checksum adjustment.\n");
+    return false;
+  }
+
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t TTFReader::table_length(uint32_t tag) const {
+  return table_headers_[tables_.at(tag).head_id].length;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -225,25 +371,11 @@ void CopyMSBArray(T *dst, T *const src, size_t size) {
   ConvertEndiannessArray(dst, size);
 }
 
-template<typename T>
-T* CreateCopyMSBArray(T *src, size_t size) {
-  assert(src != nullptr);
-  assert(size > 0);
-
-  T *v = new T[size]();
-  if (nullptr == v) {
-    return nullptr;
-  }
-  CopyMSBArray(v, src, size);
-  
-  return v;
-}
-
 } // namespace ""
 
 /* -------------------------------------------------------------------------- */
 
-void TTFReader::process_data()
+bool TTFReader::process_data()
 {
   /* HEAD TABLE */
   {
@@ -287,9 +419,16 @@ void TTFReader::process_data()
     Table_t &table = tables_[RequiredTableTAG_t::CMAP];
     uint16_t *data_u16 = reinterpret_cast<uint16_t*>(table.data);
 
+    const uint32_t length = table_length(RequiredTableTAG_t::CMAP);
+
     // CMAP index
     cmap_.index.version = ENDIANNESS(data_u16[0u]);
     cmap_.index.numberSubtables = ENDIANNESS(data_u16[1u]);
+    if ((0u == cmap_.index.numberSubtables)
+     || (length < sizeof(TCmap_index_t) + cmap_.index.numberSubtables * sizeof(TCmap_subtable_t))) {
+      fprintf(stderr, "Error : Invalid CMAP index.\n");
+      return false;
+    }
     cmap_.subtables.resize(cmap_.index.numberSubtables);
 
     // CMAP subtable info
@@ -316,12 +455,16 @@ void TTFReader::process_data()
     // !! retrieve ONLY platformID == 0 (Unicode) with format 4 !!
     //  
     const uint32_t offset = cmap_.subtables[chosen_st_index].offset;
+    if (static_cast<uint64_t>(offset) + 8u * sizeof(uint16_t) > length) {
+      fprintf(stderr, "Error : Invalid CMAP subtable offset.\n");
+      return false;
+    }
     uint16_t *subtable = data_u16 + offset/2;
 
     const uint16_t format = ENDIANNESS(subtable[0u]);
     if (format != 4) {
       fprintf(stderr, "Error : CMAP format %u is not handled yet.\n", format);
-      exit(EXIT_FAILURE);
+      return false;
     }
 
     TCmap_format4_t &cmap = cmap_.format4;
@@ -336,26 +479,31 @@ void TTFReader::process_data()
 
     const uint16_t segCount = cmap.segCountX2 >> 1;
     const uint16_t off = 8 + segCount;
+
+    // The segments arrays, reserved pad included, must fit in the table.
+    if (offset + (7u + 4u * segCount + 1u) * sizeof(uint16_t) > length) {
+      fprintf(stderr, "Error : Truncated CMAP subtable.\n");
+      return false;
+    }
     
-    cmap.endCode         = CreateCopyMSBArray(&subtable[7], segCount);
+    cmap.endCode         = BigEndianView_t<uint16_t>(&subtable[7], segCount);
     cmap.reservedPad     = subtable[7+segCount];
-    cmap.startCode       = CreateCopyMSBArray(&subtable[off+0*segCount], segCount);
-    cmap.idDelta         = CreateCopyMSBArray((int16_t*)&subtable[off+1*segCount], segCount);
-    cmap.idRangeOffset   = CreateCopyMSBArray(&subtable[off+2*segCount], segCount);
-    
-    /*---------------*/
-    uint16_t countGlyphs=0;
-    for (int i=0; i<segCount; i++) {
-      //fprintf(stderr, "%d\n", cmap.idDelta[i]);
-      countGlyphs+=cmap.endCode[i]-cmap.startCode[i]; 
-    }
-    //fprintf(stderr, "%d // %d\n", countGlyphs, maxp_.numGlyphs);
-    countGlyphs = maxp_.numGlyphs;
-    /*---------------*/
+    cmap.startCode       = BigEndianView_t<uint16_t>(&subtable[off+0*segCount], segCount);
+    cmap.idDelta         = BigEndianView_t<int16_t>(&subtable[off+1*segCount], segCount);
+    cmap.idRangeOffset   = BigEndianView_t<uint16_t>(&subtable[off+2*segCount], segCount);
+
+    // The glyph index array spans the rest of the subtable, bounded by the
+    // table itself.
+    const uint8_t *table_end = table.data + table_headers_[table.head_id].length;
+    const uint8_t *array_begin = reinterpret_cast<const uint8_t*>(&subtable[off+3*segCount]);
+    const uint8_t *array_end = std::min(
+      reinterpret_cast<const uint8_t*>(subtable) + cmap.length, table_end
+    );
+    const size_t countGlyphs = (array_end > array_begin) ? (array_end - array_begin) / sizeof(uint16_t) : 0u;
 
     // note that indexing operation might account for
     // the memory layout of the whole subtable
-    cmap.glyphIndexArray = CreateCopyMSBArray(&subtable[off+3*segCount], countGlyphs);
+    cmap.glyphIndexArray = BigEndianView_t<uint16_t>(array_begin, countGlyphs);
     
     assert(cmap.reservedPad == 0);
   }
@@ -364,14 +512,18 @@ void TTFReader::process_data()
   {
     Table_t &table = tables_[RequiredTableTAG_t::LOCA];
 
+    // It holds numGlyphs + 1 offsets, the last one ending the glyf table.
+    const uint32_t length = table_headers_[table.head_id].length;
+    const size_t count = maxp_.numGlyphs + 1u;
+
     if (head_.indexToLocFormat != 0) {
-      uint32_t *data = reinterpret_cast<uint32_t*>(table.data);
-      loca_.offset_u32 = CreateCopyMSBArray(data, maxp_.numGlyphs);
+      loca_.offset_u32 = BigEndianView_t<uint32_t>(table.data, std::min<size_t>(count, length / sizeof(uint32_t)));
     } else  {
-      uint16_t *data = reinterpret_cast<uint16_t*>(table.data);
-      loca_.offset_u16 = CreateCopyMSBArray(data, maxp_.numGlyphs);
+      loca_.offset_u16 = BigEndianView_t<uint16_t>(table.data, std::min<size_t>(count, length / sizeof(uint16_t)));
     }
   }
+
+  return true;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -380,7 +532,7 @@ uint16_t TTFReader::map_char(uint16_t c) const {
   const auto &fmt = cmap_.format4;
 
   uint16_t glyph_index = 0;
-  for (uint16_t sid=0u; fmt.endCode[sid] != 0xFFFF; ++sid)
+  for (uint16_t sid=0u; (sid < fmt.endCode.size()) && (fmt.endCode[sid] != 0xFFFF); ++sid)
   {
     //
     if (fmt.startCode[sid] == 0xFFFF) {
@@ -403,7 +555,8 @@ uint16_t TTFReader::map_char(uint16_t c) const {
       const uint16_t start = fmt.startCode[sid];
       //uint16_t *offset = &fmt.idRangeOffset[sid];
       //glyph_index = *(offset + (c - start) + (*offset)/2);
-      glyph_index = *(fmt.glyphIndexArray + (c - start));
+      const size_t array_index = c - start;
+      glyph_index = (array_index < fmt.glyphIndexArray.size()) ? fmt.glyphIndexArray[array_index] : 0u;
       glyph_index += (glyph_index) ? fmt.idDelta[sid] : 0;
     }
     glyph_index &= 0xFFFF;
@@ -420,8 +573,29 @@ uint16_t TTFReader::map_char(uint16_t c) const {
 /* -------------------------------------------------------------------------- */
 
 uint32_t TTFReader::glyph_offset(uint16_t index) const {
-  return (loca_.offset_u16) ? loca_.offset_u16[index] * 2u
-                            : loca_.offset_u32[index];
+  return (!loca_.offset_u16.empty()) ? loca_.offset_u16[index] * 2u
+                                     : loca_.offset_u32[index];
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t TTFReader::glyph_length(uint16_t index) const {
+  // An outline ends where the next one starts.
+  const size_t count = (!loca_.offset_u16.empty()) ? loca_.offset_u16.size()
+                                                   : loca_.offset_u32.size();
+  if (static_cast<size_t>(index) + 1u >= count) {
+    return 0u;
+  }
+  const uint32_t begin = glyph_offset(index);
+  const uint32_t end = glyph_offset(index + 1u);
+  return (end > begin) ? end - begin : 0u;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool TTFReader::is_empty_glyph(uint16_t c) const {
+  const uint16_t index = map_char(c);
+  return (0u != index) && (0u == glyph_length(index));
 }
 
 /* -------------------------------------------------------------------------- */
@@ -434,7 +608,15 @@ glyph_data_t const* const  TTFReader::create_glyph(uint16_t charcode) {
 
   Table_t &table = tables_[RequiredTableTAG_t::GLYF];
 
-  const uint32_t offset = glyph_offset(map_char(charcode));
+  // Glyphes without outline, like spaces, have no data, their offset being
+  // the one of the next glyph.
+  const uint16_t index = map_char(charcode);
+  if (0u == glyph_length(index)) {
+    glyphes_[charcode] = nullptr;
+    return nullptr;
+  }
+
+  const uint32_t offset = glyph_offset(index);
   uint8_t *data_ptr = (uint8_t*)table.data + offset;
   TGlyphDesc_t desc = *reinterpret_cast<TGlyphDesc_t*>(data_ptr);
   data_ptr += sizeof(TGlyphDesc_t);
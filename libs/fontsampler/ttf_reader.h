@@ -7,6 +7,8 @@
 
 #include "ttf_structs.h"
 
+class ThreadPool;
+
 /* -------------------------------------------------------------------------- */
 
 class TTFReader {
@@ -19,7 +21,8 @@ class TTFReader {
   void clear();
   
   /* Parse and store internal data of the given ttf file.
-   * @return true if it succeeds. */ 
+   * @return true if it succeeds, false if the file is malformed, unsupported
+   *         or, when validated, corrupted. */ 
   bool read(const char* ttf_filename);
 
   /* Returns a pointer to an internal glyph data if it exists, nullptr otherwise.
@@ -27,6 +30,23 @@ class TTFReader {
    **/
   glyph_data_t const* const get_glyph_data(uint16_t c);
 
+  /* Validate the checksums of the tables and of the whole font on read, for
+   * fonts from untrusted sources. Tables are summed on pool when given.
+   * Disabled by default. */
+  void set_checksum_validation(bool enabled, ThreadPool *pool = nullptr) {
+    validate_checksums_ = enabled;
+    checksum_pool_ = pool;
+  }
+
+  /* Returns true if the character maps to a glyph, without decoding it. */
+  bool has_glyph(uint16_t c) const {
+    return 0u != map_char(c);
+  }
+
+  /* Returns true if the character maps to a glyph without outline, like a
+   * space, without decoding it. */
+  bool is_empty_glyph(uint16_t c) const;
+
  private:
   typedef uint32_t TAG_t;
   
@@ -36,14 +56,22 @@ class TTFReader {
   };
 
   /* Check that the required TTF's tables tag were correctly loaded. */
-  void check_loaded_data() const;
+  bool check_loaded_data() const;
+
+  /* Check the tables checksums and the font checksum adjustment. */
+  bool validate_checksums() const;
 
-  /* Convert TTF data to internal structure for further use. */
-  void process_data();
+  /* Convert TTF data to internal structure for further use.
+   * @return false if it is malformed or unsupported. */
+  bool process_data();
+
+  /* Length in bytes of a loaded table. */
+  uint32_t table_length(uint32_t tag) const;
 
   /* Find character glyph location from its code. */
   uint16_t map_char(uint16_t c) const;
   uint32_t glyph_offset(uint16_t index) const;
+  uint32_t glyph_length(uint16_t index) const;
 
   /* Create a glyph and store it in an internal map. */
   glyph_data_t const* const create_glyph(uint16_t charcode);
@@ -64,16 +92,20 @@ class TTFReader {
   struct {
     TCmap_index_t index;
     std::vector<TCmap_subtable_t> subtables;
-    TCmap_format4_t format4;
+    TCmap_format4_t format4{};
   } cmap_;
 
+  /* The cmap and loca arrays are views over the tables data. */
   struct {
-    uint16_t *offset_u16 = nullptr;
-    uint32_t *offset_u32 = nullptr;
+    BigEndianView_t<uint16_t> offset_u16;
+    BigEndianView_t<uint32_t> offset_u32;
   } loca_;
 
   /* glyphes data cache */
   std::unordered_map<uint16_t, glyph_data_t*> glyphes_;
+
+  bool validate_checksums_ = false;
+  ThreadPool *checksum_pool_ = nullptr;
 };
 
 /* -------------------------------------------------------------------------- */
@@ -1,6 +1,7 @@
 #ifndef FONTSAMPLER_TTF_STRUCTS_H_
 #define FONTSAMPLER_TTF_STRUCTS_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -15,6 +16,42 @@ typedef int64_t   longDateTime;
 
 /* -------------------------------------------------------------------------- */
 
+/* Read-only view of a big-endian array within the file data, its values
+ * being decoded on access. The data needs no alignment. */
+template<typename T>
+class BigEndianView_t {
+ public:
+  BigEndianView_t() = default;
+
+  BigEndianView_t(const void *data, size_t size)
+    : data_(static_cast<const uint8_t*>(data))
+    , size_(size)
+  {}
+
+  T operator[](size_t i) const {
+    const uint8_t *bytes = data_ + i * sizeof(T);
+    uint32_t n = 0u;
+    for (size_t b = 0u; b < sizeof(T); ++b) {
+      n = (n << 8u) | bytes[b];
+    }
+    return static_cast<T>(n);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return 0u == size_;
+  }
+
+ private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0u;
+};
+
+/* -------------------------------------------------------------------------- */
+
 /* File Header */
 struct Header_t {
   uint32_t filetype;
@@ -143,12 +180,12 @@ struct TCmap_format4_t {
   uint16_t searchRange;
   uint16_t entrySelector;
   uint16_t rangeShift;
-  uint16_t *endCode;
+  BigEndianView_t<uint16_t> endCode;
   uint16_t reservedPad;
-  uint16_t *startCode;
-  int16_t *idDelta;
-  uint16_t *idRangeOffset;
-  uint16_t *glyphIndexArray;
+  BigEndianView_t<uint16_t> startCode;
+  BigEndianView_t<int16_t> idDelta;
+  BigEndianView_t<uint16_t> idRangeOffset;
+  BigEndianView_t<uint16_t> glyphIndexArray;
 };
 
 struct TLoca16_t {
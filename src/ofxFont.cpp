@@ -0,0 +1,63 @@
+#include "ofxFont.h"
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFont::setup(const std::string &ttf_filename)
+{
+  return read(ofToDataPath(ttf_filename));
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFont::read(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Glyphes built from the outlines of the previous file point into them, so
+  // they are retired rather than released.
+  for (auto &it : outlines_) {
+    if (it.second) {
+      retired_outlines_.push_back(std::move(it.second));
+    }
+  }
+  outlines_.clear();
+
+  loaded_ = ttf_.read(path.c_str());
+  if (!loaded_) {
+    ofLog(OF_LOG_FATAL_ERROR, "Unable to read the TTF file " + path);
+  }
+  return loaded_;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFont::hasGlyph(uint16_t c)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return loaded_ && ttf_.has_glyph(c);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFont::isEmptyGlyph(uint16_t c)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return loaded_ && ttf_.is_empty_glyph(c);
+}
+
+/* -------------------------------------------------------------------------- */
+
+const Glyph* ofxFont::getOutline(uint16_t c)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto &outline = outlines_[c];
+  if (!outline && loaded_) {
+    if (auto *ttf_glyph = ttf_.get_glyph_data(c)) {
+      outline = std::make_unique<Glyph>(*ttf_glyph);
+    }
+  }
+  return outline.get();
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "fontsampler/glyph.h"
+#include "fontsampler/thread_pool.h"
+#include "fontsampler/ttf_reader.h"
+
+/* -------------------------------------------------------------------------- */
+
+// ofxFont holds the decoded outlines of a TrueType typeface, unscaled, to be
+// shared by the ofxFontSampler of each size it is used at.
+//
+class ofxFont {
+ public:
+  ofxFont() = default;
+
+  /* Load a TrueType File from the data directory. */
+  bool setup(const std::string &ttf_filename);
+
+  /* Load a TrueType File from an already resolved path. The outlines of a
+   * previously loaded file are kept alive, as glyphes built from them may
+   * still be in use. */
+  bool read(const std::string &path);
+
+  /* Validate the checksums of the next files read, on the shared thread
+   * pool, failing on corrupted fonts. Meant for untrusted sources. */
+  void setChecksumValidation(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttf_.set_checksum_validation(enabled, &ThreadPool::Shared());
+  }
+
+  bool isLoaded() const {
+    return loaded_;
+  }
+
+  /* Return true if the font maps the character to a glyph, by probing its
+   * character map without decoding the glyph. */
+  bool hasGlyph(uint16_t c);
+
+  /* Return true if the font maps the character to a glyph without outline,
+   * like a space. */
+  bool isEmptyGlyph(uint16_t c);
+
+  /* Return the unscaled outline of a character, decoded on first request, 
+   * or nullptr if the font has none. It lives as long as the font, even when
+   * another file is read. Safe to call from several threads. */
+  const Glyph* getOutline(uint16_t c);
+
+ private:
+  std::mutex mutex_;
+  TTFReader ttf_;
+  std::atomic<bool> loaded_{false};
+  std::unordered_map<uint16_t, std::unique_ptr<Glyph>> outlines_;
+
+  // Outlines of the previously read files.
+  std::vector<std::unique_ptr<Glyph>> retired_outlines_;
+};
+
+/* -------------------------------------------------------------------------- */
@@ -2,84 +2,498 @@
 
 /* -------------------------------------------------------------------------- */
 
+namespace {
+
+/* Check if a box of the current model space may intersect the view
+ * frustum, ie. if not all its corners are outside of the same clip plane. */
+bool IsBoxInView(const glm::vec3 &min_bound, const glm::vec3 &max_bound) {
+  const glm::mat4 mvp = ofGetCurrentMatrix(OF_MATRIX_PROJECTION) 
+                      * ofGetCurrentMatrix(OF_MATRIX_MODELVIEW);
+
+  int outside[6] = { 0, 0, 0, 0, 0, 0 };
+  for (int i = 0; i < 8; ++i) {
+    const glm::vec4 p = mvp * glm::vec4(
+      (i & 1) ? max_bound.x : min_bound.x,
+      (i & 2) ? max_bound.y : min_bound.y,
+      (i & 4) ? max_bound.z : min_bound.z,
+      1.0f
+    );
+    outside[0] += (p.x < -p.w) ? 1 : 0;
+    outside[1] += (p.x > +p.w) ? 1 : 0;
+    outside[2] += (p.y < -p.w) ? 1 : 0;
+    outside[3] += (p.y > +p.w) ? 1 : 0;
+    outside[4] += (p.z < -p.w) ? 1 : 0;
+    outside[5] += (p.z > +p.w) ? 1 : 0;
+  }
+  return std::none_of(outside, outside + 6, [](int count) { return 8 == count; });
+}
+
+/* Update a moving average of a cost, in milliseconds. */
+void UpdateCost(float measure, float &cost) {
+  constexpr float kWeight = 0.25f;
+  cost = (cost > 0.0f) ? cost + kWeight * (measure - cost) : measure;
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+ofxFontRenderer::~ofxFontRenderer()
+{
+  if (pending_.valid()) {
+    pending_.wait();
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
 void ofxFontRenderer::update(
   const std::u16string &str,
   ofxGlyph::updateVertexFunc_t updateVertex
 )
 {
-  const float dx = ofMap(ofGetMouseX(), 0, ofGetWidth(), 0.0f, 1.0f);
-  const float dy = ofMap(ofGetMouseY(), 0, ofGetHeight(), 0.2f, 1.0f);
+  update(str, [updateVertex](ofxGlyph::VertexSpan_t const& span) {
+    for (int i = 0; i < span.count; ++i) {
+      updateVertex(span.positions[i], span.first_index + i, span.normals[i]);
+    }
+  });
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::update(
+  const std::u16string &str,
+  ofxGlyph::updateVerticesFunc_t updateVertices
+)
+{
+  const uint64_t start_time = ofGetElapsedTimeMicros();
+
+  if (asynchronous_) {
+    // Swap in the last completed frame, and only submit a new one when no
+    // generation is running.
+    completeAsync(false);
+    num_pending_glyphs_ = 0u;
+    num_missing_glyphs_ = 0u;
+    if (pending_.valid()) {
+      ++async_stats_.num_skipped;
+    } else {
+      submitAsync(str, std::move(updateVertices));
+    }
+  } else {
+    completeAsync(true);
+
+    resolveString(str, false, front_);
+
+    const bool budgeted = time_budget_ > 0.0f;
+    prepareJobs(front_, budgeted);
+
+    // Measured costs depend on the triangulation.
+    const auto settings = getSettings();
+    if (!(settings == cost_settings_)) {
+      cost_settings_ = settings;
+      generate_cost_per_point_ = 0.0f;
+      write_cost_per_point_ = 0.0f;
+      for (auto &it : front_.glyphs) {
+        it.second->generate_cost = 0.0f;
+        it.second->write_cost = 0.0f;
+      }
+    }
+
+    // Generate the glyphs by batches sized from their estimated costs to fit
+    // what is left of the budget, the setup and merged upload included.
+    const int concurrency = ThreadPool::Shared().getConcurrency();
+    size_t num_done = 0u;
+    while (num_done < jobs_.size()) {
+      const float elapsed = (ofGetElapsedTimeMicros() - start_time) / 1000.0f;
+      const float remaining = time_budget_ - elapsed - (merged_geometry_ ? merged_cost_ : 0.0f);
+
+      // Workers share the generations while the writes are serial.
+      float generate_sum = 0.0f;
+      float generate_max = 0.0f;
+      float write_sum = 0.0f;
+      size_t end = budgeted ? num_done : jobs_.size();
+      while (end < jobs_.size()) {
+        float generate_cost, write_cost;
+        const bool known = estimateCost(*jobs_[end], generate_cost, write_cost);
+
+        // Without any measure yet, a glyph is generated alone to get one.
+        if (!known && ((end > num_done) || (num_done > 0u))) {
+          break;
+        }
+
+        generate_sum += generate_cost;
+        generate_max = std::max(generate_max, generate_cost);
+        write_sum += write_cost;
+        const float batch_cost = std::max(generate_sum / concurrency, generate_max) + write_sum;
+        if (known && (batch_cost > remaining)) {
+          break;
+        }
+        ++end;
+
+        if (!known) {
+          break;
+        }
+      }
+
+      // When no glyph fits the budget of an update, the first one is still
+      // generated alone so the text progresses.
+      if (end == num_done) {
+        if (num_done > 0u) {
+          break;
+        }
+        end = 1u;
+      }
+
+      generateJobs(num_done, end, updateVertices, settings, merged_geometry_, update_index_, false);
+      writeJobs(num_done, end, settings, merged_geometry_, update_index_);
+      num_done = end;
+    }
+    num_pending_glyphs_ = jobs_.size() - num_done;
+    num_missing_glyphs_ = 0u;
+    for (size_t i = num_done; i < jobs_.size(); ++i) {
+      num_missing_glyphs_ += (0u == jobs_[i]->generated_index) ? 1u : 0u;
+    }
+
+    if (merged_geometry_) {
+      const uint64_t merged_start = ofGetElapsedTimeMicros();
+      updateMergedGeometry();
+      UpdateCost((ofGetElapsedTimeMicros() - merged_start) / 1000.0f, merged_cost_);
+    }
+  }
+
+  update_time_ = (ofGetElapsedTimeMicros() - start_time) / 1000.0f;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::update(const std::u16string &str)
+{
+  const uint64_t start_time = ofGetElapsedTimeMicros();
+
+  completeAsync(true);
+  resolveString(str, true, front_);
+
+  if (merged_geometry_) {
+    updateMergedGeometry();
+  }
+
+  update_time_ = (ofGetElapsedTimeMicros() - start_time) / 1000.0f;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::setAsynchronous(bool enabled)
+{
+  if (!enabled) {
+    completeAsync(true);
+  }
+  asynchronous_ = enabled;
+}
 
-  string_ = str;
+/* -------------------------------------------------------------------------- */
 
-  for (const auto &glyph_car : string_) {
-    ofxGlyph* glyph = nullptr;
+bool ofxFontRenderer::isUpdatePending() const
+{
+  return pending_.valid()
+      && (pending_.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::resolveString(const std::u16string &str, bool shared, Frame_t &frame)
+{
+  const auto settings = getSettings();
+  if (frame.resolved && (shared == frame.shared) && (str == frame.string) &&
+      (!shared || (settings == frame.settings))) {
+    return;
+  }
+  frame.resolved = true;
+  frame.shared = shared;
+  frame.settings = settings;
+  frame.string = str;
+  frame.visible.assign(str.size(), 1u);
+
+  frame.meshes.clear();
+  for (const auto &glyph_car : frame.string) {
+    if (shared) {
+      frame.meshes.push_back(cache_->acquire(glyph_car, settings));
+      continue;
+    }
+
+    auto &glyph_mesh = frame.glyphs[glyph_car];
 
     // Create the glyph object if needed.
-    if (meshes_.cend() == meshes_.find(glyph_car)) {
-      auto glyph_mesh = std::make_shared<ofxGlyphMesh>();
-      meshes_[glyph_car] = glyph_mesh;
+    if (!glyph_mesh) {
+      glyph_mesh = std::make_shared<ofxGlyphMesh>();
 
-      if (glyph = fontsampler_.get(glyph_car); glyph) {
+      if (auto *glyph = fontsampler_.get(glyph_car); glyph) {
         glyph_mesh->glyph_ptr = glyph;
         glyph->extractPath(glyph_mesh->path);
       }
-    } else {
-      glyph = meshes_[glyph_car]->glyph_ptr;
     }
+    frame.meshes.push_back(glyph_mesh);
+  }
 
-    // Update the glyph if found.
-    if (nullptr != glyph) {
-      auto glyph_mesh = meshes_[glyph_car];
-     
-      // Evaluate a glyph path and extract its mesh data for triangulation.
-      glyph->extractMeshData(
-        8,                                // sub samples count (per curves)
-        true,                             // Enable segment subsampling
-        polygon_.points, 
-        polygon_.segments, 
-        polygon_.holes,  
-        4,                                // gradient step
-        updateVertex
-      );
-
-      // Triangulate & generate Voronoi diagram for the glyph.
-      {
-        auto &mesh = glyph_mesh->face;
-        mesh.triangulateConstrainedDelaunay(polygon_, 24, 620); 
-        mesh.generateVoronoiDiagram();
-      }
+  // The glyphs sources may have changed.
+  merged_builder_.clear();
+}
 
-      // Generate a tristrip for its extruded edge.
-      {
-        auto &mesh = glyph_mesh->edge;
-
-        const float edge_width{ 1.0f }; //
-        
-        mesh.clearVertices();
-        for (const auto& v : polygon_.points) {
-          mesh.addVertex(ofPoint(v.x, v.y, v.z));
-          mesh.addVertex(ofPoint(v.x, v.y, v.z - edge_width));
-        }
+/* -------------------------------------------------------------------------- */
 
-        if (!mesh.hasIndices()) {
-          mesh.setMode(OF_PRIMITIVE_TRIANGLES);
-          for (const auto& s : polygon_.segments) {
-            const auto i1 = 2*s.x;
-            const auto i2 = 2*s.y;
-            
-            mesh.addIndex(i1 + 1);
-            mesh.addIndex(i1);
-            mesh.addIndex(i2 + 1);
-
-            mesh.addIndex(i2 + 1);
-            mesh.addIndex(i1);
-            mesh.addIndex(i2);
-          }
-        }
+void ofxFontRenderer::prepareJobs(Frame_t &frame, bool prioritize)
+{
+  const auto settings = getSettings();
+
+  // Each glyph is updated once per call, its mesh being shared by all its
+  // occurrences.
+  ++update_index_;
+
+  jobs_.clear();
+  for (const auto &glyph_mesh : frame.meshes) {
+    if ((glyph_mesh->update_index != update_index_) && (nullptr != glyph_mesh->glyph_ptr)) {
+      glyph_mesh->update_index = update_index_;
+      glyph_mesh->base = &glyph_mesh->glyph_ptr->getMeshData(settings.subsamples, true);
+      glyph_mesh->visible = false;
+      jobs_.push_back(glyph_mesh.get());
+    }
+  }
+
+  // A glyph is visible when any of its occurrences is.
+  for (size_t i = 0; i < frame.meshes.size(); ++i) {
+    if (frame.visible[i]) {
+      frame.meshes[i]->visible = true;
+    }
+  }
+
+  if (!prioritize) {
+    return;
+  }
+
+  // The least recently generated glyphs come first, those never generated
+  // having an index of 0.
+  std::stable_sort(jobs_.begin(), jobs_.end(), [](const ofxGlyphMesh *a, const ofxGlyphMesh *b) {
+    if (a->visible != b->visible) {
+      return a->visible;
+    }
+    return a->generated_index < b->generated_index;
+  });
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::generateJobs(
+  size_t begin,
+  size_t end,
+  ofxGlyph::updateVerticesFunc_t const& updateVertices,
+  ofxGlyphMesh::Settings_t const& settings,
+  bool merged,
+  uint64_t revision,
+  bool background
+)
+{
+  // Displace and triangulate the glyphs in parallel, each worker using its
+  // own triangulator.
+  auto &pool = ThreadPool::Shared();
+  triangulators_.resize(pool.getConcurrency());
+
+  pool.parallelFor(static_cast<int>(end - begin), 1, [&](int first, int last, int participant) {
+    for (int i = first; i < last; ++i) {
+      auto *glyph_mesh = jobs_[begin + i];
+      const uint64_t start_time = ofGetElapsedTimeMicros();
+      glyph_mesh->generate(settings, updateVertices, triangulators_[participant]);
+      glyph_mesh->last_generate_cost = (ofGetElapsedTimeMicros() - start_time) / 1000.0f;
+      if (background) {
+        glyph_mesh->writeMeshes(settings, merged, revision);
+        glyph_mesh->generated_index = revision;
       }
+    }
+  });
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::writeJobs(
+  size_t begin,
+  size_t end,
+  ofxGlyphMesh::Settings_t const& settings,
+  bool merged,
+  uint64_t revision
+)
+{
+  for (size_t i = begin; i < end; ++i) {
+    auto *glyph_mesh = jobs_[i];
+    const uint64_t start_time = ofGetElapsedTimeMicros();
+    glyph_mesh->writeMeshes(settings, merged, revision);
+    glyph_mesh->triangulateFace(settings, merged);
+    glyph_mesh->generated_index = revision;
+    const float write_cost = (ofGetElapsedTimeMicros() - start_time) / 1000.0f;
+
+    // Record the costs per glyph, and per sampled point for the glyphs
+    // never measured.
+    const size_t num_points = std::max<size_t>(glyph_mesh->base->vertices.size(), 1u);
+    UpdateCost(glyph_mesh->last_generate_cost, glyph_mesh->generate_cost);
+    UpdateCost(write_cost, glyph_mesh->write_cost);
+    glyph_mesh->cost_num_points = num_points;
+    UpdateCost(glyph_mesh->last_generate_cost / num_points, generate_cost_per_point_);
+    UpdateCost(write_cost / num_points, write_cost_per_point_);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFontRenderer::estimateCost(
+  const ofxGlyphMesh &glyph_mesh,
+  float &generate_cost,
+  float &write_cost
+) const
+{
+  const size_t num_points = std::max<size_t>(glyph_mesh.base->vertices.size(), 1u);
+
+  // Scale the glyph own costs to its current sample count.
+  if (glyph_mesh.generate_cost > 0.0f) {
+    const float scale = num_points / static_cast<float>(glyph_mesh.cost_num_points);
+    generate_cost = scale * glyph_mesh.generate_cost;
+    write_cost = scale * glyph_mesh.write_cost;
+    return true;
+  }
+
+  generate_cost = num_points * generate_cost_per_point_;
+  write_cost = num_points * write_cost_per_point_;
+  return generate_cost_per_point_ > 0.0f;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::submitAsync(
+  const std::u16string &str,
+  ofxGlyph::updateVerticesFunc_t updateVertices
+)
+{
+  // The glyphs are looked up on the calling thread, the background task
+  // only accessing the back frame meshes.
+  resolveString(str, false, back_);
+  prepareJobs(back_, false);
+
+  const auto settings = getSettings();
+  const bool merged = merged_geometry_;
+  const uint64_t revision = update_index_;
+  pending_settings_ = settings;
+  pending_merged_ = merged;
+
+  auto task = std::make_shared<std::packaged_task<void()>>(
+    [this, updateVertices = std::move(updateVertices), settings, merged, revision]() {
+      const uint64_t start_time = ofGetElapsedTimeMicros();
+      generateJobs(0u, jobs_.size(), updateVertices, settings, merged, revision, true);
+      generation_time_ = (ofGetElapsedTimeMicros() - start_time) / 1000.0f;
+    }
+  );
+  pending_ = task->get_future();
+  submit_time_ = ofGetElapsedTimeMicros();
+  ++async_stats_.num_submitted;
+
+  ThreadPool::Shared().submit([task]() { (*task)(); });
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFontRenderer::completeAsync(bool blocking)
+{
+  if (!pending_.valid()) {
+    return false;
+  }
+  if (!blocking && (pending_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+    return false;
+  }
+  pending_.get();
+
+  // The constrained Delaunay triangulations are not re-entrant, so they are
+  // left to the calling thread.
+  for (auto *glyph_mesh : jobs_) {
+    glyph_mesh->triangulateFace(pending_settings_, pending_merged_);
+  }
+
+  // The drawn frame is only changed by the calling thread, so swapping the
+  // frames is atomic for draw.
+  std::swap(front_, back_);
 
+  auto &stats = async_stats_;
+  const float latency = (ofGetElapsedTimeMicros() - submit_time_) / 1000.0f;
+  ++stats.num_completed;
+  stats.last_latency = latency;
+  stats.average_latency += (latency - stats.average_latency) / stats.num_completed;
+  stats.max_latency = std::max(stats.max_latency, latency);
+  stats.last_generation_time = generation_time_;
+
+  if (merged_geometry_) {
+    updateMergedGeometry();
+  }
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontRenderer::updateMergedGeometry()
+{
+  const float kFront[4] = { 255 / 255.0f, 105 / 255.0f, 130 / 255.0f, 1.0f };
+  const float kEdge[4]  = {  50 / 255.0f,  55 / 255.0f,  70 / 255.0f, 1.0f };
+  const float kBack[4]  = { 255 / 255.0f, 175 / 255.0f, 130 / 255.0f, 1.0f };
+
+  TextMeshBuilder::Params_t params;
+  params.extrusion = extrusion_scale_;
+  std::copy(kFront, kFront + 4, params.colors[TextMeshBuilder::kFront]);
+  std::copy(kEdge,  kEdge + 4,  params.colors[TextMeshBuilder::kEdge]);
+  std::copy(kBack,  kBack + 4,  params.colors[TextMeshBuilder::kBack]);
+
+  // Place the glyphs as draw does with the matrix stack : each one is
+  // rotated twice by alpha, around its centroid then around its origin,
+  // before moving to the next one.
+  merged_instances_.clear();
+  float pen_x = 0.0f;
+  for (size_t i = 0; i < front_.meshes.size(); ++i) {
+    const auto glyph_car = front_.string[i];
+    const auto &gm = front_.meshes[i];
+    if (nullptr == gm->glyph_ptr) {
+      continue;
     }
+
+    const auto center = gm->glyph_ptr->getCentroid();
+    const float alpha = glm::radians(0.5f * (glyph_car - 'e'));
+    const float c1 = cosf(alpha), s1 = sinf(alpha);
+    const float c2 = cosf(2.0f * alpha), s2 = sinf(2.0f * alpha);
+
+    TextMeshBuilder::Instance_t instance{ &gm->source, {
+      c2, -s2, 0.0f, pen_x + center.x - (c1 * center.x - s1 * center.y),
+      s2,  c2, 0.0f,         center.y - (s1 * center.x + c1 * center.y),
+      0.0f, 0.0f, 1.0f, 0.0f
+    }};
+    merged_instances_.push_back(instance);
+
+    pen_x += gm->glyph_ptr->getMaxBound().x;
+  }
+
+  const auto changes = merged_builder_.build(
+    merged_instances_.data(), static_cast<int>(merged_instances_.size()), params
+  );
+
+  // Upload the whole buffers when the layout changed, and only the rewritten
+  // vertices otherwise.
+  using Vertex_t = TextMeshBuilder::Vertex_t;
+  const auto &vertices = merged_builder_.getVertices();
+  if (changes.layout) {
+    const auto &indices = merged_builder_.getIndices();
+    merged_indices_.assign(indices.begin(), indices.end());
+
+    merged_vertex_buffer_.allocate(vertices, GL_DYNAMIC_DRAW);
+    merged_index_buffer_.allocate(merged_indices_, GL_STATIC_DRAW);
+    merged_vbo_.setVertexBuffer(merged_vertex_buffer_, 3, sizeof(Vertex_t), offsetof(Vertex_t, x));
+    merged_vbo_.setColorBuffer(merged_vertex_buffer_, sizeof(Vertex_t), offsetof(Vertex_t, r));
+    merged_vbo_.setIndexBuffer(merged_index_buffer_);
+  } else if (changes.num_vertices > 0) {
+    merged_vertex_buffer_.updateData(
+      changes.first_vertex * sizeof(Vertex_t),
+      changes.num_vertices * sizeof(Vertex_t),
+      vertices.data() + changes.first_vertex
+    );
   }
 }
 
@@ -93,8 +507,8 @@ void ofxFontRenderer::draw()
   ofBackground(bgcolor);
 
   // Center to first glyph pivot.
-  if (!string_.empty()) {
-    auto *g = meshes_[string_[0]]->glyph_ptr;
+  if (!front_.meshes.empty() && front_.meshes[0]->glyph_ptr) {
+    auto *g = front_.meshes[0]->glyph_ptr;
     ofTranslate(
       0.0f,
       0.5f * ofGetHeight() - g->getCentroid().y, 
@@ -102,11 +516,17 @@ void ofxFontRenderer::draw()
     );
   }
 
-  for (auto &glyph_car : string_) {
-    const auto &ref = meshes_.find(glyph_car);
+  // Draw the whole string at once, with its vertex colors.
+  if (merged_geometry_) {
+    merged_vbo_.drawElements(GL_TRIANGLES, static_cast<int>(merged_indices_.size()));
+    return;
+  }
+
+  for (size_t i = 0; i < front_.meshes.size(); ++i) {
+    const auto glyph_car = front_.string[i];
+    const auto &gm = front_.meshes[i];
 
-    if (ref != meshes_.end()) {
-      auto gm = ref->second;
+    if (nullptr != gm->glyph_ptr) {
       const auto center    = gm->glyph_ptr->getCentroid();
       const auto max_bound = gm->glyph_ptr->getMaxBound();
       const float alpha    = 0.5f * (glyph_car - 'e'); 
@@ -121,11 +541,22 @@ void ofxFontRenderer::draw()
         // Rotate letter at its corner.
         ofRotateDeg(alpha);
 
+        // Keep track of the glyphs in view to generate them first.
+        const auto min_bound = gm->glyph_ptr->getMinBound();
+        front_.visible[i] = IsBoxInView(
+          glm::vec3(min_bound.x, min_bound.y, -extrusion_scale_),
+          glm::vec3(max_bound.x, max_bound.y, 0.0f)
+        ) ? 1u : 0u;
+
         // Draw its perturbated trianglemesh.
         {
           // front side
           ofSetColor(255, 105, 130);
-          gm->face.drawWireframe(); //
+          if (fast_triangulation_) {
+            gm->fill.drawWireframe();
+          } else {
+            gm->face.drawWireframe(); //
+          }
 
           //if (extrusion_scale_ > glm::epsilon<float>()) 
           {
@@ -139,7 +570,11 @@ void ofxFontRenderer::draw()
             // back side
             ofTranslate( 0.0f, 0.0f, -extrusion_scale_); //
             ofSetColor(255, 175, 130);
-            gm->face.draw();
+            if (fast_triangulation_) {
+              gm->fill.draw();
+            } else {
+              gm->face.draw();
+            }
           }
         }
 
@@ -1,21 +1,19 @@
 #pragma once
 
+#include <future>
 #include <unordered_map>
 #include <memory>
 
+#include "fontsampler/text_mesh_builder.h"
+#include "fontsampler/thread_pool.h"
+#include "fontsampler/triangulator.h"
+
 #include "ofMain.h"
 #include "ofxFontSampler.h"
-#include "ofxTriangleMesh.h"
-
+#include "ofxGlyphMesh.h"
+#include "ofxGlyphMeshCache.h"
 
 
-struct ofxGlyphMesh {
-  ofxGlyph *glyph_ptr = nullptr;
-
-  ofPath path;
-  ofxTriangleMesh face;
-  ofMesh edge;
-};
 
 ///
 /// ofxFontRenderer simplify how to draw a given style to a text. [WiP]
@@ -23,16 +21,46 @@ struct ofxGlyphMesh {
 class ofxFontRenderer {
  public:
   static constexpr float kDefaultExtrusionScale = 1.0f;
+  static constexpr int kSubsamples = 8;
+
+  /* Statistics of the asynchronous generations. */
+  struct AsyncStats_t {
+    uint64_t num_submitted = 0u;
+    uint64_t num_completed = 0u;
+    uint64_t num_skipped = 0u;    // updates made while a generation was running.
+    float last_latency = 0.0f;    // from submission to swap, in milliseconds.
+    float average_latency = 0.0f;
+    float max_latency = 0.0f;
+    float last_generation_time = 0.0f;
+  };
 
  public:
-  ofxFontRenderer(ofxFontSampler& fontsampler)
+  /* Static texts are drawn from the meshes of cache, shared by every
+   * renderer using it, or from a cache of their own when none is given. */
+  ofxFontRenderer(ofxFontSampler& fontsampler, std::shared_ptr<ofxGlyphMeshCache> cache = nullptr)
     : fontsampler_(fontsampler)
+    , cache_(cache ? cache : std::make_shared<ofxGlyphMeshCache>(fontsampler))
     , extrusion_scale_(kDefaultExtrusionScale)
   {}
 
+  ~ofxFontRenderer();
+
+  /* Set a static text, drawn with the undisplaced meshes of the cache. */
+  void update(const std::u16string &s);
+
+  /* Update the meshes of the string glyphs, generated in parallel on the
+   * shared thread pool : the displacement functor is called concurrently
+   * for different glyphs and must be thread-safe. The drawn meshes are only
+   * written by the calling thread.
+   * Glyphs whose sampled topology is unchanged only have their vertex
+   * positions rewritten, their connectivity being rebuilt when it changes.
+   * In asynchronous mode the functor is copied and called after returning. */
   void update(const std::u16string &s, 
               ofxGlyph::updateVertexFunc_t updateVertex);
 
+  void update(const std::u16string &s, 
+              ofxGlyph::updateVerticesFunc_t updateVertices);
+
   void draw();
 
   float getExtrusionScale() const {
@@ -43,13 +71,188 @@ class ofxFontRenderer {
     extrusion_scale_ = scale;
   }
 
+  /* Triangulate the faces by ear clipping instead of constrained Delaunay,
+   * which is faster but gives no Voronoi diagram nor quality triangles. */
+  void setFastTriangulation(bool enabled) {
+    fast_triangulation_ = enabled;
+  }
+
+  bool isFastTriangulation() const {
+    return fast_triangulation_;
+  }
+
+  /* Bake the whole string into a single buffer drawn at once, its glyphs
+   * being placed on the CPU. Faces are ear clipped and drawn filled. */
+  void setMergedGeometry(bool enabled) {
+    if (enabled && !merged_geometry_) {
+      merged_builder_.clear();
+    }
+    merged_geometry_ = enabled;
+  }
+
+  bool isMergedGeometry() const {
+    return merged_geometry_;
+  }
+
+  /* Generate animated texts in the background into a back frame, while the
+   * last completed one is drawn. Each update swaps in the frame completed
+   * since the previous one, then submits a new generation unless one is
+   * still running. Disabling it waits for the running generation.
+   * Constrained Delaunay faces, not being re-entrant, are still triangulated
+   * on the calling thread when the frame is swapped in. */
+  void setAsynchronous(bool enabled);
+
+  bool isAsynchronous() const {
+    return asynchronous_;
+  }
+
+  /* True while a background generation is running. */
+  bool isUpdatePending() const;
+
+  const AsyncStats_t& getAsyncStats() const {
+    return async_stats_;
+  }
+
+  std::shared_ptr<ofxGlyphMeshCache> getCache() const {
+    return cache_;
+  }
+
+  /* Limit the time spent by each synchronous animated update, in
+   * milliseconds, or 0 for none. Glyphs are then generated by batches sized
+   * from their averaged measured costs to fit what is left of the budget,
+   * the merged upload included, those left being resumed by the following
+   * updates. Glyphs in view when last drawn come first, then those never
+   * generated, then the least recently generated. When no glyph fits, the
+   * first one is still generated alone so the text always progresses. */
+  void setTimeBudget(float milliseconds) {
+    time_budget_ = milliseconds;
+  }
+
+  float getTimeBudget() const {
+    return time_budget_;
+  }
+
+  /* Number of distinct glyphs of the string left out by the last update. */
+  size_t getNumPendingGlyphs() const {
+    return num_pending_glyphs_;
+  }
+
+  /* Number of distinct glyphs of the string never generated yet. */
+  size_t getNumMissingGlyphs() const {
+    return num_missing_glyphs_;
+  }
+
+  /* Duration of the last update, in milliseconds. */
+  float getUpdateTime() const {
+    return update_time_;
+  }
+
  private:
+  ofxGlyphMesh::Settings_t getSettings() const {
+    return { kSubsamples, fast_triangulation_ || merged_geometry_ };
+  }
+
+  /* Meshes of a string, shared with the cache for static texts or owned by
+   * the frame for animated ones. */
+  struct Frame_t {
+    std::u16string string;
+    std::vector<std::shared_ptr<ofxGlyphMesh>> meshes;  // per character.
+    std::unordered_map<uint16_t, std::shared_ptr<ofxGlyphMesh>> glyphs;
+    std::vector<uint8_t> visible;                       // per character.
+    bool resolved = false;
+    bool shared = false;
+    ofxGlyphMesh::Settings_t settings;
+  };
+
+  /* Look up the meshes of the string characters once per string, from the
+   * cache when shared, the per-character accesses then using an array. */
+  void resolveString(const std::u16string &s, bool shared, Frame_t &frame);
+
+  /* Collect the glyphs of an animated frame to generate, on the calling
+   * thread, sorted by priority when prioritize is set. */
+  void prepareJobs(Frame_t &frame, bool prioritize);
+
+  /* Displace and triangulate the collected glyphs of [begin, end) in
+   * parallel. Their meshes are also written by the workers when background
+   * is set, the back frame owning them, but for the constrained Delaunay
+   * faces left to completeAsync. */
+  void generateJobs(
+    size_t begin,
+    size_t end,
+    ofxGlyph::updateVerticesFunc_t const& updateVertices,
+    ofxGlyphMesh::Settings_t const& settings,
+    bool merged,
+    uint64_t revision,
+    bool background
+  );
+
+  /* Write the meshes of the collected glyphs of [begin, end), drawn by the
+   * front frame, on the calling thread, and record their costs. */
+  void writeJobs(
+    size_t begin,
+    size_t end,
+    ofxGlyphMesh::Settings_t const& settings,
+    bool merged,
+    uint64_t revision
+  );
+
+  /* Estimate the generation and write costs of a glyph, in milliseconds,
+   * from its last measures or else from the costs per sampled point.
+   * Return false when nothing was measured yet. */
+  bool estimateCost(const ofxGlyphMesh &glyph_mesh, float &generate_cost, float &write_cost) const;
+
+  /* Submit the generation of an animated frame in the background. */
+  void submitAsync(const std::u16string &s, ofxGlyph::updateVerticesFunc_t updateVertices);
+
+  /* Swap in the frame of the background generation, if any, waiting for it
+   * when blocking is set. Return true if it was swapped. */
+  bool completeAsync(bool blocking);
+
+  /* Place the string glyphs in the merged buffer and upload its changes. */
+  void updateMergedGeometry();
+
   ofxFontSampler& fontsampler_;
 
-  std::u16string string_;
-  std::unordered_map<uint16_t, std::shared_ptr<ofxGlyphMesh>> meshes_;
+  std::shared_ptr<ofxGlyphMeshCache> cache_;
+
+  // Drawn frame, and the one generated in the background.
+  Frame_t front_;
+  Frame_t back_;
+  uint64_t update_index_ = 0u;
+
+  // Glyphs updated by the current call, and a triangulator per worker.
+  std::vector<ofxGlyphMesh*> jobs_;
+  std::vector<Triangulator> triangulators_;
+
+  // Single buffer of the whole string.
+  TextMeshBuilder merged_builder_;
+  std::vector<TextMeshBuilder::Instance_t> merged_instances_;
+  std::vector<ofIndexType> merged_indices_;
+  ofBufferObject merged_vertex_buffer_;
+  ofBufferObject merged_index_buffer_;
+  ofVbo merged_vbo_;
 
-  // Use to generate mesh data.
-  ofxTriangleMesh::Polygon_t polygon_;
   float extrusion_scale_;
+  bool fast_triangulation_ = false;
+  bool merged_geometry_ = false;
+  float update_time_ = 0.0f;
+
+  // Per update time budget, and the averaged costs used to fit it, in
+  // milliseconds.
+  float time_budget_ = 0.0f;
+  ofxGlyphMesh::Settings_t cost_settings_;
+  float generate_cost_per_point_ = 0.0f;
+  float write_cost_per_point_ = 0.0f;
+  float merged_cost_ = 0.0f;
+  size_t num_pending_glyphs_ = 0u;
+  size_t num_missing_glyphs_ = 0u;
+
+  // Background generation.
+  bool asynchronous_ = false;
+  std::future<void> pending_;
+  ofxGlyphMesh::Settings_t pending_settings_;
+  bool pending_merged_ = false;
+  uint64_t submit_time_ = 0u;
+  float generation_time_ = 0.0f;
+  AsyncStats_t async_stats_;
 };
\ No newline at end of file
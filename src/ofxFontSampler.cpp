@@ -9,6 +9,21 @@ const std::u16string ofxFontSampler::kDefaultChars = std::u16string(
 
 /* -------------------------------------------------------------------------- */
 
+template<typename Pred_t>
+void ofxFontSampler::eraseEntries(Pred_t pred)
+{
+  for (auto it = glyphes_.begin(); it != glyphes_.end();) {
+    if (pred(it->second)) {
+      delete it->second.glyph;
+      it = glyphes_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
 ofxFontSampler::~ofxFontSampler()
 {
   clear();
@@ -16,46 +31,338 @@ ofxFontSampler::~ofxFontSampler()
 
 /* -------------------------------------------------------------------------- */
 
-bool ofxFontSampler::setup(const std::string &ttf_filename, float fontsize)
+bool ofxFontSampler::setup(const std::string &ttf_filename, float fontsize, const std::u16string &charset)
 {
-  scale_x_ = +fontsize;
-  scale_y_ = -fontsize;
-
-  const auto &path = ofToDataPath(ttf_filename);
-  if (!ttf_.read(path.c_str())) {
-    ofLog(OF_LOG_FATAL_ERROR, "Unable to read the TTF file " + path);
+  auto font = std::make_shared<ofxFont>();
+  if (!font->setup(ttf_filename)) {
     return false;
   }
+  return setup(font, fontsize, charset);
+}
 
-  // preload default characters.
-  for (auto c : kDefaultChars) {
-    get(c);
+/* -------------------------------------------------------------------------- */
+
+bool ofxFontSampler::setup(std::shared_ptr<ofxFont> font, float fontsize, const std::u16string &charset)
+{
+  stopLoading();
+  read_future_ = {};
+  setup_future_ = {};
+
+  if (!font || !font->isLoaded()) {
+    return false;
   }
+  bind(font, fontsize);
+
+  // preload the charset.
+  num_preloaded_ = 0u;
+  num_to_preload_ = charset.size();
+  preload(charset);
+  updateAtlas();
 
   return true;
 }
 
 /* -------------------------------------------------------------------------- */
 
+std::shared_future<bool> ofxFontSampler::setupAsync(const std::string &ttf_filename, float fontsize, const std::u16string &charset)
+{
+  // The path is resolved on the calling thread, as it may depend on its
+  // working directory.
+  return load(std::make_shared<ofxFont>(), ofToDataPath(ttf_filename), fontsize, charset);
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::shared_future<bool> ofxFontSampler::setupAsync(std::shared_ptr<ofxFont> font, float fontsize, const std::u16string &charset)
+{
+  return load(font, "", fontsize, charset);
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxFontSampler::isLoading() const
+{
+  return setup_future_.valid()
+      && (setup_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+}
+
+/* -------------------------------------------------------------------------- */
+
+float ofxFontSampler::getLoadingProgress() const
+{
+  return (num_to_preload_ > 0u) ? num_preloaded_ / static_cast<float>(num_to_preload_) : 1.0f;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void ofxFontSampler::clear()
 {
-  for (auto &it : glyphes_) {
-    delete it.second;
+  stopLoading();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  eraseEntries([](Entry_t const&) { return true; });
+
+  for (auto *glyph : retired_glyphes_) {
+    delete glyph;
   }
-  glyphes_.clear();
+  retired_glyphes_.clear();
+  retired_fonts_.clear();
 }
 
 /* -------------------------------------------------------------------------- */
 
 ofxGlyph* ofxFontSampler::get(uint16_t c)
 {
-  if (glyphes_.cend() == glyphes_.find(c)) {
-    if (auto *ttf_glyph = ttf_.get_glyph_data(c)) { 
-      Glyph *glyph = new Glyph(*ttf_glyph, scale_x_, scale_y_);
-      glyphes_[c] = new ofxGlyph(glyph);
+  // Wait for the file when it is read in the background.
+  if (read_future_.valid() && !read_future_.get()) {
+    return nullptr;
+  }
+  auto *glyph = acquire(c).glyph;
+
+  // Only the calling thread modifies the atlas.
+  if (atlas_) {
+    updateAtlas();
+  }
+  return glyph;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int ofxFontSampler::getFontIndex(uint16_t c)
+{
+  if (read_future_.valid() && !read_future_.get()) {
+    return kMissingFont;
+  }
+  return acquire(c).font_index;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::addFallback(std::shared_ptr<ofxFont> font)
+{
+  if (!font) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  fallbacks_.push_back(font);
+  eraseEntries([](Entry_t const& entry) {
+    return kMissingFont == entry.font_index;
+  });
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::clearFallbacks()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Glyphes already returned may still be referenced, eg. by an
+  // ofxGlyphMeshCache, so they are retired rather than deleted, along with
+  // the fonts owning their outlines.
+  for (auto it = glyphes_.begin(); it != glyphes_.end();) {
+    if (it->second.font_index > 0) {
+      if (it->second.glyph) {
+        retired_glyphes_.push_back(it->second.glyph);
+      }
+      it = glyphes_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  retired_fonts_.insert(retired_fonts_.end(), fallbacks_.begin(), fallbacks_.end());
+  fallbacks_.clear();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::setAtlas(GlyphAtlas *atlas)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    atlas_ = atlas;
+    atlas_queue_.clear();
+    if (nullptr == atlas_) {
+      return;
+    }
+
+    for (auto &it : glyphes_) {
+      const auto &entry = it.second;
+      if (entry.glyph && !atlas_->contains(it.first)) {
+        addToAtlas(it.first, *getChainFont(entry.font_index)->getOutline(it.first));
+      }
     }
   }
-  return glyphes_[c];
+  updateAtlas();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::updateAtlas()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (atlas_) {
+    for (const auto &bitmap : atlas_queue_) {
+      if (!atlas_->insert(bitmap.c, bitmap.width, bitmap.height, bitmap.pixels.data(), bitmap.width)) {
+        ofLog(OF_LOG_WARNING, "Glyph too large for the atlas pages.");
+      }
+    }
+  }
+  atlas_queue_.clear();
+}
+
+/* -------------------------------------------------------------------------- */
+
+std::shared_future<bool> ofxFontSampler::load(
+  std::shared_ptr<ofxFont> font,
+  const std::string &path,
+  float fontsize,
+  const std::u16string &charset
+)
+{
+  stopLoading();
+
+  auto read_promise = std::make_shared<std::promise<bool>>();
+  auto setup_promise = std::make_shared<std::promise<bool>>();
+  read_future_ = read_promise->get_future().share();
+  setup_future_ = setup_promise->get_future().share();
+
+  num_preloaded_ = 0u;
+  num_to_preload_ = charset.size();
+
+  if (!font) {
+    read_promise->set_value(false);
+    setup_promise->set_value(false);
+    return setup_future_;
+  }
+  bind(font, fontsize);
+
+  loader_ = std::thread([this, font, path, charset, read_promise, setup_promise]() {
+    const bool succeed = path.empty() ? font->isLoaded() : font->read(path);
+    read_promise->set_value(succeed);
+
+    if (succeed) {
+      preload(charset);
+    }
+    setup_promise->set_value(succeed && !stop_loading_);
+  });
+
+  return setup_future_;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::bind(std::shared_ptr<ofxFont> font, float fontsize)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // The glyphes view the outlines of the previous font at the previous size.
+  eraseEntries([](Entry_t const&) { return true; });
+  atlas_queue_.clear();
+
+  font_ = font;
+  scale_x_ = +fontsize;
+  scale_y_ = -fontsize;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::preload(const std::u16string &charset)
+{
+  // The lock is taken per character, so get() can decode the characters it
+  // misses in between.
+  for (auto c : charset) {
+    if (stop_loading_) {
+      break;
+    }
+    acquire(c);
+    ++num_preloaded_;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::stopLoading()
+{
+  if (loader_.joinable()) {
+    stop_loading_ = true;
+    loader_.join();
+    stop_loading_ = false;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+ofxFont* ofxFontSampler::getChainFont(int index) const
+{
+  return (0 == index) ? font_.get() : fallbacks_[index - 1].get();
+}
+
+/* -------------------------------------------------------------------------- */
+
+ofxFontSampler::Entry_t ofxFontSampler::acquire(uint16_t c)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (auto it = glyphes_.find(c); it != glyphes_.end()) {
+    return it->second;
+  }
+
+  // Before setup the character is not resolved, to be probed again later.
+  if (!font_) {
+    return Entry_t();
+  }
+
+  // Resolve the character to the first font of the chain having it, their
+  // character maps being probed before decoding anything.
+  auto &entry = glyphes_[c];
+  const int num_fonts = 1 + static_cast<int>(fallbacks_.size());
+  for (int i = 0; i < num_fonts; ++i) {
+    auto *font = getChainFont(i);
+    if (!font->hasGlyph(c)) {
+      continue;
+    }
+
+    // Empty glyphes, like spaces, have no outline.
+    if (font->isEmptyGlyph(c)) {
+      entry.font_index = i;
+      break;
+    }
+
+    // Glyphes whose outline can not be built, eg. composite ones, are looked
+    // up in the next fonts.
+    if (auto *outline = font->getOutline(c)) {
+      // Scaled view of the outline decoded once for every size.
+      Glyph *glyph = new Glyph(*outline, scale_x_, scale_y_);
+      entry.font_index = i;
+      entry.glyph = new ofxGlyph(glyph);
+
+      if (atlas_) {
+        addToAtlas(c, *outline);
+      }
+      break;
+    }
+  }
+  return entry;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxFontSampler::addToAtlas(uint16_t c, const Glyph &outline)
+{
+  // The rasterizer expects the y-axis pointing up.
+  const Glyph glyph(outline, scale_x_, -scale_y_);
+  const auto layout = Rasterizer::GetLayout(glyph);
+  if ((0 == layout.width) || (0 == layout.height)) {
+    return;
+  }
+
+  // The atlas may be read meanwhile, so the bitmap is only queued.
+  Bitmap_t bitmap{ c, layout.width, layout.height, std::vector<uint8_t>(layout.width * layout.height) };
+  rasterizer_.rasterize(glyph, layout, bitmap.pixels.data(), layout.width);
+  atlas_queue_.push_back(std::move(bitmap));
 }
 
 /* -------------------------------------------------------------------------- */
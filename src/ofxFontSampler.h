@@ -2,15 +2,25 @@
 
 #include "ofMain.h"
 
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
-#include "fontsampler/ttf_reader.h"
+#include "fontsampler/glyph_atlas.h"
+#include "fontsampler/rasterizer.h"
 
+#include "ofxFont.h"
 #include "ofxGlyph.h"
 
 /* -------------------------------------------------------------------------- */
 
 // ofxFontSampler is an interface to the fontsampler library used to sample and
 // and render font glyphes.
+// It is a view of an ofxFont at a given size, several sizes sharing the same
+// font and thus its decoded outlines, scaled as they are sampled.
+// Characters missing from the font are looked up in an ordered chain of
+// fallback fonts, the font resolving each character being cached with it.
 //
 // important :
 // this whole OpenFramework library is higly "work in progress" and still in
@@ -20,22 +30,150 @@ class ofxFontSampler {
  public:
   static const std::u16string kDefaultChars;
 
+  // Font index of the characters no font of the chain has.
+  static constexpr int kMissingFont = -1;
+
   ofxFontSampler() = default;
   ~ofxFontSampler();
   
   void clear();
 
-  /* Load a TrueType File as TypeFace with all default characters. */
-  bool setup(const std::string &ttf_filename, float font_size);
+  /* Load a TrueType File as TypeFace, preloading the characters of charset. */
+  bool setup(const std::string &ttf_filename, float font_size, const std::u16string &charset = kDefaultChars);
+
+  /* Use a loaded font at the given size, preloading the characters of
+   * charset. */
+  bool setup(std::shared_ptr<ofxFont> font, float font_size, const std::u16string &charset = kDefaultChars);
+
+  /* Load a TrueType File as TypeFace on a background thread, which then
+   * preloads the characters of charset, and return immediately.
+   * Meanwhile get() serves the glyphes already loaded and decodes the others
+   * on demand, waiting for the file to be read if needed.
+   * @return a future set once the charset is preloaded, to false if the
+   *         file could not be read. */
+  std::shared_future<bool> setupAsync(const std::string &ttf_filename, float font_size, const std::u16string &charset = kDefaultChars);
+
+  /* Use a loaded font at the given size, preloading the characters of
+   * charset on a background thread. */
+  std::shared_future<bool> setupAsync(std::shared_ptr<ofxFont> font, float font_size, const std::u16string &charset = kDefaultChars);
 
-  /* Return the ofxGlyph object of the given character. */
+  /* True while an asynchronous setup is running. */
+  bool isLoading() const;
+
+  /* Ratio of the setup charset already preloaded, in [0, 1]. */
+  float getLoadingProgress() const;
+
+  /* Return the ofxGlyph object of the given character, from the first font
+   * of the chain having it, or nullptr if none has. */
   ofxGlyph* get(uint16_t c);
 
+  /* Index in the chain of the font the character is resolved to, 0 being
+   * the font set up and the next ones the fallbacks, or kMissingFont. */
+  int getFontIndex(uint16_t c);
+
+  /* Font viewed by the sampler, to be shared with other sizes. */
+  std::shared_ptr<ofxFont> getFont() const {
+    return font_;
+  }
+
+  /* Append a loaded font to the fallback chain. Characters missing from
+   * every font so far are resolved again, though meshes already generated
+   * from them, eg. by an ofxGlyphMeshCache, are not. */
+  void addFallback(std::shared_ptr<ofxFont> font);
+
+  /* Remove the fallback fonts. The glyphes resolved to them are resolved
+   * again on request, those already returned staying valid until clear(),
+   * to be dropped from their users, eg. by recreating an ofxGlyphMeshCache. */
+  void clearFallbacks();
+
+  size_t getNumFallbacks() const {
+    return fallbacks_.size();
+  }
+
+  /* Rasterize the loaded glyphes, and any new one, into an atlas keyed by
+   * character. Set to nullptr to stop updating it.
+   * The atlas is only modified on the calling thread, by setAtlas(), get()
+   * and updateAtlas(), the glyphes preloaded in the background being queued
+   * until then. So while isLoading() is true it must not be read from any
+   * other thread, and it lacks the glyphes not applied yet. */
+  void setAtlas(GlyphAtlas *atlas);
+
+  /* Insert the queued glyphes into the atlas. */
+  void updateAtlas();
+
  private:
-  TTFReader ttf_;
-  float scale_x_;
-  float scale_y_;
-  std::unordered_map<uint16_t, ofxGlyph*> glyphes_;
+  /* View font at font_size, and preload charset on a background thread
+   * after reading path into font when it is not empty. */
+  std::shared_future<bool> load(
+    std::shared_ptr<ofxFont> font,
+    const std::string &path,
+    float font_size,
+    const std::u16string &charset
+  );
+
+  /* View font at font_size. */
+  void bind(std::shared_ptr<ofxFont> font, float font_size);
+
+  /* Load the characters of charset, until the loading is stopped. */
+  void preload(const std::u16string &charset);
+
+  /* Stop the background loading, if any, and wait for it. */
+  void stopLoading();
+
+  struct Entry_t {
+    ofxGlyph *glyph = nullptr;
+    int font_index = kMissingFont;
+  };
+
+  /* Return the font of the chain at index. */
+  ofxFont* getChainFont(int index) const;
+
+  /* Return the entry of a character, resolving it through the chain and
+   * creating its glyph if needed, once the file is read. */
+  Entry_t acquire(uint16_t c);
+
+  /* Delete the glyphes of the entries matching pred and remove them. */
+  template<typename Pred_t>
+  void eraseEntries(Pred_t pred);
+
+  /* Rasterize a glyph and queue it for the atlas. */
+  void addToAtlas(uint16_t c, const Glyph &outline);
+
+  // Guards the fallbacks, the glyphes and the atlas queue against the loader
+  // thread.
+  std::mutex mutex_;
+
+  // Background loading.
+  std::thread loader_;
+  std::shared_future<bool> read_future_;
+  std::shared_future<bool> setup_future_;
+  std::atomic<bool> stop_loading_{false};
+  std::atomic<size_t> num_preloaded_{0u};
+  size_t num_to_preload_ = 0u;
+
+  std::shared_ptr<ofxFont> font_;
+  std::vector<std::shared_ptr<ofxFont>> fallbacks_;
+  float scale_x_ = 1.0f;
+  float scale_y_ = 1.0f;
+
+  // Resolved characters, missing ones included so they are probed once.
+  std::unordered_map<uint16_t, Entry_t> glyphes_;
+
+  // Glyphes resolved to removed fallbacks, and their fonts, kept until clear.
+  std::vector<ofxGlyph*> retired_glyphes_;
+  std::vector<std::shared_ptr<ofxFont>> retired_fonts_;
+
+  // Glyph bitmap waiting to be inserted into the atlas.
+  struct Bitmap_t {
+    uint16_t c;
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+  };
+
+  GlyphAtlas *atlas_ = nullptr;
+  Rasterizer rasterizer_;
+  std::vector<Bitmap_t> atlas_queue_;
 };
 
 /* -------------------------------------------------------------------------- */
@@ -3,17 +3,6 @@
 
 /* -------------------------------------------------------------------------- */
 
-namespace {
-
-/* Return the normal of a segment. */
-ofPoint CalculateNormal(const ofPoint &vertex0, const ofPoint &vertex1) {
-  return (vertex1 - vertex0).rotate(90.0f, ofVec3f(0,0,-1)).normalize();
-}
-
-};  // namespace
-
-/* -------------------------------------------------------------------------- */
-
 ofxGlyph::ofxGlyph(Glyph *glyph)
   : fs_glyph_(glyph)
   , outer_path(nullptr)
@@ -25,6 +14,23 @@ ofxGlyph::ofxGlyph(Glyph *glyph)
       break;
     }
   }
+
+  // Find the strongest curvature, |p0 - 2 p1 + p2|, of the glyph curves.
+  for (int i = 0; i < fs_glyph_->getNumPaths(); ++i) {
+    const auto &gp = fs_glyph_->getPath(i);
+    const int num_vertices = gp->getNumVertices();
+    for (int j = 0; j < num_vertices; ++j) {
+      if (gp->getFlag(j) & GlyphPath::ON_CURVE) {
+        continue;
+      }
+      const vertex_t &p0(gp->getVertex((j + num_vertices - 1) % num_vertices));
+      const vertex_t &p1(gp->getVertex(j));
+      const vertex_t &p2(gp->getVertex((j + 1) % num_vertices));
+      const float ddx = p0.x - 2.0f * p1.x + p2.x;
+      const float ddy = p0.y - 2.0f * p1.y + p2.y;
+      max_curvature_ = std::max(max_curvature_, sqrtf(ddx*ddx + ddy*ddy));
+    }
+  }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -111,6 +117,26 @@ void ofxGlyph::extractPath(ofPath &path) const
 
 /* -------------------------------------------------------------------------- */
 
+int ofxGlyph::extractCurveMesh(ofMesh &mesh) const
+{
+  CurveTriangulator triangulator;
+  CurveTriangulator::Mesh_t data;
+  triangulator.triangulate(*fs_glyph_, data);
+
+  mesh.clear();
+  mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+  for (const auto &v : data.vertices) {
+    mesh.addVertex(glm::vec3(v.x, v.y, 0.0f));
+    mesh.addTexCoord(glm::vec2(v.u, v.v));
+    mesh.addNormal(glm::vec3(0.0f, 0.0f, v.sign));
+  }
+  mesh.getIndices().assign(data.indices.begin(), data.indices.end());
+
+  return data.num_curve_triangles;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void ofxGlyph::extractMeshData(
   int                     subsamples,
   bool                    enable_segments_sampling,
@@ -119,21 +145,138 @@ void ofxGlyph::extractMeshData(
   std::vector<glm::vec3>  &holes
 )
 {
-  vertices.clear();
-  segments.clear();
-  holes.clear();
+  const auto &data = getMeshData(subsamples, enable_segments_sampling);
+  vertices.assign(data.vertices.begin(), data.vertices.end());
+  segments.assign(data.segments.begin(), data.segments.end());
+  holes.assign(data.holes.begin(), data.holes.end());
+}
+
+/* -------------------------------------------------------------------------- */
+
+const ofxGlyph::MeshData_t& ofxGlyph::getMeshData(
+  int   subsamples,
+  bool  enable_segments_sampling
+)
+{
+  return acquireMeshData(subsamples, enable_segments_sampling);
+}
+
+/* -------------------------------------------------------------------------- */
+
+const ofMesh& ofxGlyph::getFillMesh(
+  int   subsamples,
+  bool  enable_segments_sampling
+)
+{
+  auto &data = acquireMeshData(subsamples, enable_segments_sampling);
+  if (data.has_fill_mesh) {
+    return data.fill_mesh;
+  }
+
+  const bool succeed = triangulator_.triangulate(
+    reinterpret_cast<const float*>(data.vertices.data()), 3, data.vertices.size(),
+    reinterpret_cast<const int*>(data.segments.data()), data.segments.size(),
+    fill_indices_
+  );
+
+  auto &mesh = data.fill_mesh;
+  if (succeed) {
+    mesh.clear();
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    mesh.addVertices(data.vertices);
+    mesh.getIndices().assign(fill_indices_.begin(), fill_indices_.end());
+  } else {
+    // A partial ear clipping would leave holes in the fill, so the outline
+    // is tessellated by ofPath instead.
+    ofLog(OF_LOG_WARNING, "ofxGlyph : ear clipping failed, using the path tessellation.");
+
+    ofPath path;
+    path.setCurveResolution(subsamples);
+    extractPath(path);
+    mesh = path.getTessellation();
+  }
+  data.has_fill_mesh = true;
+
+  return mesh;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::extractFillMesh(
+  int                     subsamples,
+  bool                    enable_segments_sampling,
+  std::vector<glm::vec3>  &vertices,
+  std::vector<uint32_t>   &indices
+)
+{
+  const auto &mesh = getFillMesh(subsamples, enable_segments_sampling);
+  vertices.assign(mesh.getVertices().begin(), mesh.getVertices().end());
+  indices.assign(mesh.getIndices().begin(), mesh.getIndices().end());
+}
+
+/* -------------------------------------------------------------------------- */
+
+ofxGlyph::MeshData_t& ofxGlyph::acquireMeshData(
+  int   subsamples,
+  bool  enable_segments_sampling
+)
+{
+  // Cached levels are shared with the sampling LODs.
+  const auto *lod = findSamplingLOD(subsamples, enable_segments_sampling);
+  if (lod) {
+    subsamples = lod->subsamples;
+  }
+
+  MeshData_t *data = nullptr;
+  for (auto &d : mesh_data_) {
+    if ((d->subsamples == subsamples) 
+     && (d->enable_segments_sampling == enable_segments_sampling)) {
+      data = d.get();
+      break;
+    }
+  }
+
+  if (nullptr == data) {
+    mesh_data_.push_back(std::make_unique<MeshData_t>());
+    data = mesh_data_.back().get();
+    data->subsamples = subsamples;
+    data->enable_segments_sampling = enable_segments_sampling;
+    buildMeshData(lod, *data);
+  }
+
+  // Keep the public outer sampling in sync with the last setting used.
+  if (data != last_mesh_data_) {
+    outer_sampling_ = data->outer_sampling;
+    last_mesh_data_ = data;
+  }
+
+  return *data;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::buildMeshData(const SamplingLOD_t *lod, MeshData_t &data) const
+{
+  GlyphPath::Sampling_t path_sampling;
+
+  data.path_offsets.push_back(0);
 
   int first_index = 0;
   int vertex_index = first_index;
   for (int i = 0; i < fs_glyph_->getNumPaths(); ++i) {
-    GlyphPath::Sampling_t sampling;
-    auto const *path(fs_glyph_->getPath(i));
+    if (nullptr == lod) {
+      fs_glyph_->getPath(i)->sample(
+        path_sampling, 
+        data.subsamples, 
+        data.enable_segments_sampling,
+        true
+      );
+    }
+    const auto &sampling = (lod) ? lod->paths[i] : path_sampling;
 
-    path->sample(
-      sampling, 
-      subsamples, 
-      enable_segments_sampling
-    );
+    for (const auto &n : sampling.normals) {
+      data.normals.push_back(glm::vec3(n.x, n.y, 0.0f));
+    }
     
     ofPoint centroid(0.0f, 0.0f);
     const int num_vertices = sampling.vertices.size();
@@ -141,27 +284,47 @@ void ofxGlyph::extractMeshData(
     {
       // Vertex.
       ofPoint vertex(v.x, v.y);
-      vertices.push_back(vertex);
+      data.vertices.push_back(vertex);
       centroid += vertex;
 
       // Segment indices.
       const int next_index = first_index + (vertex_index+1 - first_index) % num_vertices;
-      segments.push_back(glm::ivec2(vertex_index++, next_index));
+      data.segments.push_back(glm::ivec2(vertex_index++, next_index));
     }
     centroid *= 1.0f / num_vertices;
     first_index = vertex_index;
+    data.path_offsets.push_back(first_index);
 
     // Holes.
     if (fs_glyph_->isInnerPath(i)) {
-      holes.push_back(centroid);
+      data.holes.push_back(centroid);
     } else {
-      outer_sampling_ = sampling;
+      data.outer_sampling = sampling;
     }
   }
 }
 
 /* -------------------------------------------------------------------------- */
 
+void ofxGlyph::displaceMeshData(
+  int                     subsamples,
+  bool                    enable_segments_sampling,
+  std::vector<glm::vec3>  &vertices,
+  updateVertexFunc_t      updateVertex
+)
+{
+  const auto &data = getMeshData(subsamples, enable_segments_sampling);
+  const int num_vertices = static_cast<int>(data.vertices.size());
+
+  vertices.resize(num_vertices);
+  for (int i = 0; i < num_vertices; ++i) {
+    vertices[i] = data.vertices[i];
+    updateVertex(vertices[i], i, data.normals[i]);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
 void ofxGlyph::constructContourPolyline(
   int samples,
   ofPolyline &pl
@@ -187,41 +350,15 @@ void ofxGlyph::extractMeshData(
   std::vector<glm::vec3>  &vertices,
   std::vector<glm::ivec2> &segments,
   std::vector<glm::vec3>  &holes,
-  int                     gradient_step,
   updateVertexFunc_t      updateVertex
 )
 {
-  extractMeshData(subsamples, enable_segments_sampling, vertices, segments, holes);
-
-  std::vector<glm::vec3> points(vertices.size());
-  int prev_vertex_index = -1;
-  int first_vertex_index = -1;
-  int last_vertex_index = -1;
+  const auto &data = getMeshData(subsamples, enable_segments_sampling);
+  segments.assign(data.segments.begin(), data.segments.end());
+  holes.assign(data.holes.begin(), data.holes.end());
 
-  // Postprocess the vertex data using a custome gradient functor.
-  const int num_segments = static_cast<int>(segments.size());
-  for (int i = 0; i < num_segments; ++i) {
-    const auto &s = segments[i];
-
-    // if new path : look for the last segment looping the path.
-    if (prev_vertex_index != s.x) {
-      first_vertex_index = s.x;
-      int j;
-      for (j=i+1; segments[j].y != first_vertex_index; ++j);
-      last_vertex_index = segments[j].x;
-    }
-    prev_vertex_index = s.y;
-
-    // Calculate normal.
-    const int i0 = ofWrap(s.x-gradient_step, first_vertex_index, last_vertex_index);
-    const int i1 = ofWrap(s.x+gradient_step, first_vertex_index, last_vertex_index);
-    const auto normal = CalculateNormal(vertices[i0], vertices[i1]);
-    
-    points[i] = vertices[s.x];
-    updateVertex(points[i], s.x, normal);    
-  }
-
-  std::swap(vertices, points);// = points;
+  // Postprocess the vertex data using a custom gradient functor.
+  displaceMeshData(subsamples, enable_segments_sampling, vertices, updateVertex);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -229,27 +366,19 @@ void ofxGlyph::extractMeshData(
 void ofxGlyph::constructContourPolyline(
   int                 samples, 
   ofPolyline          &pl,
-  float               gradient_step_factor,
   updateVertexFunc_t  updateVertex
 )
 {
   const float sampling_step = 1.0f / samples;
-  const float gradient_sampling_step = gradient_step_factor * sampling_step;
   
   pl.clear();
   for (int i = 0; i < samples; ++i) {
     const float t = i * sampling_step;
 
-    // Calculate normal.
-    const auto v0 = outer_sampling_.evaluate(t - gradient_sampling_step);
-    const auto v1 = outer_sampling_.evaluate(t + gradient_sampling_step);
-    const ofPoint vertex0(v0.x, v0.y);
-    const ofPoint vertex1(v1.x, v1.y);
-    const ofPoint normal = CalculateNormal(vertex0, vertex1);
-
     const vertex_t& v = outer_sampling_.evaluate(t);
+    const vertex_t& n = outer_sampling_.evaluateNormal(t);
     auto vertex = glm::vec3(v.x, v.y, 0);
-    updateVertex(vertex, i, normal);
+    updateVertex(vertex, i, glm::vec3(n.x, n.y, 0));
 
     pl.addVertex(vertex);
   }
@@ -258,3 +387,253 @@ void ofxGlyph::constructContourPolyline(
 }
 
 /* -------------------------------------------------------------------------- */
+
+ofxGlyph::updateVerticesFunc_t ofxGlyph::NoiseDisplacement(NoiseParams_t const& params)
+{
+  static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 is expected to be packed.");
+
+  return [params](VertexSpan_t const& span) {
+    SimplexNoise::Displace(
+      reinterpret_cast<float*>(span.positions),
+      reinterpret_cast<float const*>(span.normals),
+      3,
+      span.count,
+      params
+    );
+  };
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::extractMeshData(
+  int                     subsamples,
+  bool                    enable_segments_sampling,
+  std::vector<glm::vec3>  &vertices,
+  std::vector<glm::ivec2> &segments,
+  std::vector<glm::vec3>  &holes,
+  updateVerticesFunc_t    updateVertices
+)
+{
+  const auto &data = getMeshData(subsamples, enable_segments_sampling);
+  segments.assign(data.segments.begin(), data.segments.end());
+  holes.assign(data.holes.begin(), data.holes.end());
+
+  displaceMeshData(subsamples, enable_segments_sampling, vertices, updateVertices);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::displaceMeshData(
+  int                     subsamples,
+  bool                    enable_segments_sampling,
+  std::vector<glm::vec3>  &vertices,
+  updateVerticesFunc_t    updateVertices
+)
+{
+  DisplaceMeshData(getMeshData(subsamples, enable_segments_sampling), vertices, updateVertices);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::DisplaceMeshData(
+  MeshData_t const&             data,
+  std::vector<glm::vec3>        &vertices,
+  updateVerticesFunc_t const&   updateVertices
+)
+{
+  vertices.assign(data.vertices.begin(), data.vertices.end());
+
+  const auto &offsets = data.path_offsets;
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    const VertexSpan_t span{
+      vertices.data() + offsets[i],
+      data.normals.data() + offsets[i],
+      offsets[i],
+      offsets[i+1] - offsets[i]
+    };
+    updateVertices(span);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::constructContourPolyline(
+  int                   samples,
+  ofPolyline            &pl,
+  updateVerticesFunc_t  updateVertices
+)
+{
+  const float sampling_step = 1.0f / samples;
+
+  std::vector<glm::vec3> positions(samples);
+  std::vector<glm::vec3> normals(samples);
+  for (int i = 0; i < samples; ++i) {
+    const float t = i * sampling_step;
+    const vertex_t& v = outer_sampling_.evaluate(t);
+    const vertex_t& n = outer_sampling_.evaluateNormal(t);
+    positions[i] = glm::vec3(v.x, v.y, 0);
+    normals[i] = glm::vec3(n.x, n.y, 0);
+  }
+  updateVertices(VertexSpan_t{ positions.data(), normals.data(), 0, samples });
+
+  pl.clear();
+  pl.addVertices(positions);
+  // Close the polyline.
+  pl.addVertex(positions[0]);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::setupSamplingLODs(
+  const std::vector<int> &levels,
+  bool enable_segments_sampling
+)
+{
+  std::vector<int> subsamples(levels);
+  std::sort(subsamples.begin(), subsamples.end());
+  subsamples.erase(std::unique(subsamples.begin(), subsamples.end()), subsamples.end());
+
+  lods_.clear();
+  lods_.resize(subsamples.size());
+  lods_segments_sampling_ = enable_segments_sampling;
+
+  for (size_t i = 0; i < subsamples.size(); ++i) {
+    auto &lod = lods_[i];
+    lod.subsamples = std::max(subsamples[i], 1);
+    lod.paths.resize(fs_glyph_->getNumPaths());
+    for (int j = 0; j < fs_glyph_->getNumPaths(); ++j) {
+      fs_glyph_->getPath(j)->sample(lod.paths[j], lod.subsamples, enable_segments_sampling, true);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::clearSamplingLODs()
+{
+  lods_.clear();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::clearMeshData()
+{
+  mesh_data_.clear();
+  last_mesh_data_ = nullptr;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int ofxGlyph::getNearestSamplingLOD(int subsamples) const
+{
+  int nearest = subsamples;
+  int best_delta = std::numeric_limits<int>::max();
+  for (const auto &lod : lods_) {
+    const int delta = std::abs(lod.subsamples - subsamples);
+    if (delta < best_delta) {
+      best_delta = delta;
+      nearest = lod.subsamples;
+    }
+  }
+  return nearest;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int ofxGlyph::selectSamplingLOD(float screen_size, float tolerance) const
+{
+  // The flattening error of a quadratic curve uniformly split in n
+  // is bounded by |p0 - 2 p1 + p2| / (4 n^2).
+  const float height = getMaxBound().y - getMinBound().y;
+  const float pixel_scale = screen_size / std::max(fabsf(height), glm::epsilon<float>());
+  const float error = pixel_scale * max_curvature_ / (4.0f * std::max(tolerance, glm::epsilon<float>()));
+  const int subsamples = std::max(1, static_cast<int>(ceilf(sqrtf(error))));
+
+  if (lods_.empty()) {
+    return subsamples;
+  }
+  for (const auto &lod : lods_) {
+    if (lod.subsamples >= subsamples) {
+      return lod.subsamples;
+    }
+  }
+  return lods_.back().subsamples;
+}
+
+/* -------------------------------------------------------------------------- */
+
+const ofxGlyph::SamplingLOD_t* ofxGlyph::findSamplingLOD(
+  int subsamples,
+  bool enable_segments_sampling
+) const
+{
+  if (lods_.empty() || (enable_segments_sampling != lods_segments_sampling_)) {
+    return nullptr;
+  }
+  const int nearest = getNearestSamplingLOD(subsamples);
+  for (const auto &lod : lods_) {
+    if (lod.subsamples == nearest) {
+      return &lod;
+    }
+  }
+  return nullptr;
+}
+
+/* -------------------------------------------------------------------------- */
+
+const GlyphGrid& ofxGlyph::getGrid() const
+{
+  std::call_once(grid_flag_, [this]() {
+    grid_.build(*fs_glyph_);
+  });
+  return grid_;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool ofxGlyph::contains(const glm::vec3 &p) const
+{
+  return getGrid().contains(vertex_t(p.x, p.y));
+}
+
+/* -------------------------------------------------------------------------- */
+
+float ofxGlyph::distance(const glm::vec3 &p, glm::vec3 *nearest) const
+{
+  vertex_t v;
+  const float d = getGrid().distance(vertex_t(p.x, p.y), &v);
+  if (nearest) {
+    *nearest = glm::vec3(v.x, v.y, 0.0f);
+  }
+  return d;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::contains(
+  const std::vector<glm::vec3> &points,
+  std::vector<uint8_t> &out,
+  ThreadPool *pool
+) const
+{
+  out.resize(points.size());
+  if (!points.empty()) {
+    getGrid().contains(&points[0].x, 3, points.size(), out.data(), pool);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyph::distance(
+  const std::vector<glm::vec3> &points,
+  std::vector<float> &out,
+  ThreadPool *pool
+) const
+{
+  out.resize(points.size());
+  if (!points.empty()) {
+    getGrid().distance(&points[0].x, 3, points.size(), out.data(), nullptr, pool);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
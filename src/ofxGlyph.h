@@ -1,7 +1,13 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
+#include <type_traits>
+#include "fontsampler/curve_triangulator.h"
 #include "fontsampler/glyph.h"
+#include "fontsampler/glyph_grid.h"
+#include "fontsampler/simplex_noise.h"
+#include "fontsampler/triangulator.h"
 
 #include "ofMain.h"
 
@@ -11,6 +17,27 @@ class ofxGlyph {
  public:
   using updateVertexFunc_t = std::function<void(glm::vec3&, int, glm::vec3 const&)>; 
 
+  /* Contiguous vertices of a path, displaced in place by a batch callback.
+   * The vertex at positions[i] has the index first_index + i. */
+  struct VertexSpan_t {
+    glm::vec3       *positions;
+    glm::vec3 const *normals;
+    int             first_index;
+    int             count;
+  };
+  using updateVerticesFunc_t = std::function<void(VertexSpan_t const&)>;
+
+  /* Parameters of the noise displacement along the vertex normals. */
+  using NoiseParams_t = SimplexNoise::Params_t;
+
+  /* Batch callback displacing vertices by vectorized simplex noise, usable
+   * with extractMeshData, displaceMeshData and constructContourPolyline. */
+  static updateVerticesFunc_t NoiseDisplacement(NoiseParams_t const& params);
+
+  /* True for functors callable as an updateVertexFunc_t. */
+  template<typename F>
+  static constexpr bool IsVertexFunctor = std::is_invocable_v<F&, glm::vec3&, int, glm::vec3 const&>;
+
   explicit ofxGlyph(Glyph *glyph);
   ~ofxGlyph();
 
@@ -24,13 +51,22 @@ class ofxGlyph {
   /* Transform the glyph into an openframework path object.*/
   void extractPath(ofPath &path) const;
 
+  /* Resolution independent mesh of the glyph, made of its interior polygon
+   * and one triangle per curve, see CurveTriangulator.
+   * Texture coordinates hold the Bezier coordinates (u, v) and the normals
+   * z-axis the sign, a fragment being covered when sign * (u*u - v) < 0.
+   * @return the number of curve triangles, emitted first. */
+  int extractCurveMesh(ofMesh &mesh) const;
+
   /* Extract the data needed to triangulate the mesh of the glyph.
    * @param subsamples : number of subsample to use per curves.
    * @param enable_segments_sampling : if true, subsample both curve and segments,
    *        otherwise only the curve are and segment only keep their two vertices.
    * @param vertices : output buffer for the sampled 2d vertices.
    * @param segments : output buffer for the vertex indices of each sub-segments.
-   * @param holes : output buffer for the centroid of each holes in the resulting polygon. */
+   * @param holes : output buffer for the centroid of each holes in the resulting polygon.
+   * @note the geometry is sampled once per setting and cached (see getMeshData),
+   *       when sampling levels are set up, the nearest cached level is used. */
   void extractMeshData(
     int                     subsamples,
     bool                    enable_segments_sampling,
@@ -49,9 +85,9 @@ class ofxGlyph {
   // Helpers methods that act like the previous ones but allows
   // the user to specify a functor to modify the vertice along the
   // vertex normal.
-  // @param gradientScaling : functor taking a vertex index, a vertex and a contour normal as parameters 
-  //  and returning a new vertex.
-  // @param gradient_step : distance used to calculated the vertex normal.
+  // @param updateVertex : functor taking a vertex, its index and its
+  //  contour normal as parameters and modifying the vertex in place.
+  // The normals are exact, derived from the curves while sampling.
   // ---------------------------------------------------------------
   
   void extractMeshData(
@@ -60,23 +96,244 @@ class ofxGlyph {
     std::vector<glm::vec3>  &vertices,
     std::vector<glm::ivec2> &segments,
     std::vector<glm::vec3>  &holes,
-    int                     gradient_step,
     updateVertexFunc_t      updateVertex
   );
 
   void constructContourPolyline(
     int                   samples,
     ofPolyline            &pl,
-    float                 gradient_step_factor,
     updateVertexFunc_t    updateVertex
   );
 
+  // ---------------------------------------------------------------
+  // Batch versions, calling updateVertices once per path with
+  // contiguous spans of positions and normals, so the displacement
+  // kernel can be vectorized. The polyline is a single span.
+  // ---------------------------------------------------------------
+
+  void extractMeshData(
+    int                     subsamples,
+    bool                    enable_segments_sampling,
+    std::vector<glm::vec3>  &vertices,
+    std::vector<glm::ivec2> &segments,
+    std::vector<glm::vec3>  &holes,
+    updateVerticesFunc_t    updateVertices
+  );
+
+  void constructContourPolyline(
+    int                   samples,
+    ofPolyline            &pl,
+    updateVerticesFunc_t  updateVertices
+  );
+
+  // ---------------------------------------------------------------
+  // Cached base geometry.
+  // The undeformed sampling of the glyph is computed once per
+  // sampling setting, so animated glyphes only need to displace
+  // their vertices each frame. An entry is kept for every distinct
+  // setting requested until clearMeshData, so the cache is bounded
+  // by the settings used.
+  // ---------------------------------------------------------------
+
+  /* Undeformed mesh data of a sampling setting. */
+  struct MeshData_t {
+    int subsamples;
+    bool enable_segments_sampling;
+
+    std::vector<glm::vec3>  vertices;
+    std::vector<glm::vec3>  normals;
+    std::vector<glm::ivec2> segments;
+    std::vector<glm::vec3>  holes;
+
+    // First vertex index of each path, with a trailing total count.
+    std::vector<int> path_offsets;
+
+    GlyphPath::Sampling_t outer_sampling;
+
+    // Filled triangles of the vertices, built on first use by getFillMesh.
+    ofMesh fill_mesh;
+    bool has_fill_mesh = false;
+  };
+
+  /* Return the base geometry of a sampling setting, sampled on first use.
+   * It stays valid until clearMeshData. */
+  const MeshData_t& getMeshData(int subsamples, bool enable_segments_sampling);
+
+  /* Release the cached base geometries, with their fill meshes. It
+   * invalidates the references returned by getMeshData and getFillMesh, so
+   * it must only be called when none is held, eg. by the base of an
+   * ofxGlyphMesh, once the ofxGlyphMeshCache or ofxFontRenderer using the
+   * glyph is destroyed. */
+  void clearMeshData();
+
+  /* Write the vertices of data displaced by updateVertices into vertices,
+   * calling it once per path. Only reads data, so it can be called from any
+   * thread once the data was returned by getMeshData. */
+  static void DisplaceMeshData(
+    MeshData_t const&             data,
+    std::vector<glm::vec3>        &vertices,
+    updateVerticesFunc_t const&   updateVertices
+  );
+
+  /* Return the filled mesh of a sampling setting, triangulated from the 
+   * glyph paths by the core triangulator without ofPath tessellation.
+   * It is built on first use and cached with the setting geometry.
+   * When the triangulator fails, eg. on an open contour, it falls back to
+   * the tessellation of the glyph ofPath, whose vertices differ from the
+   * sampled ones. */
+  const ofMesh& getFillMesh(int subsamples, bool enable_segments_sampling = false);
+
+  /* Copy the filled mesh of a sampling setting as vertex and index arrays. */
+  void extractFillMesh(
+    int                     subsamples,
+    bool                    enable_segments_sampling,
+    std::vector<glm::vec3>  &vertices,
+    std::vector<uint32_t>   &indices
+  );
+
+  /* Write the base vertices displaced by updateVertex into vertices, 
+   * reusing its memory. The topology is the one of getMeshData and of
+   * extractMeshData with the same setting. */
+  void displaceMeshData(
+    int                     subsamples,
+    bool                    enable_segments_sampling,
+    std::vector<glm::vec3>  &vertices,
+    updateVertexFunc_t      updateVertex
+  );
+
+  /* Batch version, see VertexSpan_t. */
+  void displaceMeshData(
+    int                     subsamples,
+    bool                    enable_segments_sampling,
+    std::vector<glm::vec3>  &vertices,
+    updateVerticesFunc_t    updateVertices
+  );
+
+  /* Version taking any functor callable as an updateVertexFunc_t, 
+   * called directly so it can be inlined. */
+  template<typename F, typename = std::enable_if_t<IsVertexFunctor<F>>>
+  void displaceMeshData(
+    int                     subsamples,
+    bool                    enable_segments_sampling,
+    std::vector<glm::vec3>  &vertices,
+    F                       &&updateVertex
+  )
+  {
+    const auto &data = getMeshData(subsamples, enable_segments_sampling);
+    const int num_vertices = static_cast<int>(data.vertices.size());
+
+    vertices.resize(num_vertices);
+    glm::vec3 *positions = vertices.data();
+    glm::vec3 const *base = data.vertices.data();
+    glm::vec3 const *normals = data.normals.data();
+    for (int i = 0; i < num_vertices; ++i) {
+      positions[i] = base[i];
+      updateVertex(positions[i], i, normals[i]);
+    }
+  }
+
+  /* extractMeshData taking any functor callable as an updateVertexFunc_t. */
+  template<typename F, typename = std::enable_if_t<IsVertexFunctor<F>>>
+  void extractMeshData(
+    int                     subsamples,
+    bool                    enable_segments_sampling,
+    std::vector<glm::vec3>  &vertices,
+    std::vector<glm::ivec2> &segments,
+    std::vector<glm::vec3>  &holes,
+    F                       &&updateVertex
+  )
+  {
+    const auto &data = getMeshData(subsamples, enable_segments_sampling);
+    segments.assign(data.segments.begin(), data.segments.end());
+    holes.assign(data.holes.begin(), data.holes.end());
+    displaceMeshData(subsamples, enable_segments_sampling, vertices, std::forward<F>(updateVertex));
+  }
+
+  // ---------------------------------------------------------------
+  // Sampling levels of detail.
+  // Once set, the paths are sampled a single time per level and 
+  // extractMeshData uses the cached level nearest to the requested 
+  // subsamples count instead of sampling the paths again.
+  // ---------------------------------------------------------------
+
+  /* Precompute the paths sampling for each subsamples count of levels. */
+  void setupSamplingLODs(const std::vector<int> &levels, bool enable_segments_sampling);
+
+  /* Release the cached levels. */
+  void clearSamplingLODs();
+
+  bool hasSamplingLODs() const {
+    return !lods_.empty();
+  }
+
+  /* Return the cached subsamples count nearest to subsamples, or subsamples
+   * itself when no levels are cached. */
+  int getNearestSamplingLOD(int subsamples) const;
+
+  /* Return the cached subsamples count best suited to display the glyph at
+   * the given on-screen height (in pixels), so that its curves deviate 
+   * from their sampling by less than tolerance pixels. */
+  int selectSamplingLOD(float screen_size, float tolerance = kDefaultLODTolerance) const;
+
+  static constexpr float kDefaultLODTolerance = 0.5f;
+
+  // ---------------------------------------------------------------
+  // Spatial queries against the glyph outline, flattened with the
+  // default number of subsamples. The acceleration grid is built
+  // once, on first use.
+  // ---------------------------------------------------------------
+
+  const GlyphGrid& getGrid() const;
+
+  /* True if p is inside the glyph, using the nonzero winding rule. */
+  bool contains(const glm::vec3 &p) const;
+
+  /* Distance from p to the glyph outline, with its closest point. */
+  float distance(const glm::vec3 &p, glm::vec3 *nearest = nullptr) const;
+
+  /* Batch versions, processed in parallel when a pool is given. */
+  void contains(const std::vector<glm::vec3> &points, std::vector<uint8_t> &out, ThreadPool *pool = nullptr) const;
+  void distance(const std::vector<glm::vec3> &points, std::vector<float> &out, ThreadPool *pool = nullptr) const;
+
  public:
   GlyphPath const* outer_path;
   GlyphPath::Sampling_t outer_sampling_; //
 
  private:
+  struct SamplingLOD_t {
+    int subsamples;
+    std::vector<GlyphPath::Sampling_t> paths;
+  };
+
+  /* Return the mesh data of a setting, building it on first use. */
+  MeshData_t& acquireMeshData(int subsamples, bool enable_segments_sampling);
+
+  /* Sample the paths of a mesh data setting, from a cached level if any. */
+  void buildMeshData(const SamplingLOD_t *lod, MeshData_t &data) const;
+
+  /* Return the cached level for subsamples if any, nullptr otherwise. */
+  const SamplingLOD_t* findSamplingLOD(int subsamples, bool enable_segments_sampling) const;
+
    Glyph const* fs_glyph_;
+
+  // Sampling levels, sorted by increasing subsamples.
+  std::vector<SamplingLOD_t> lods_;
+  bool lods_segments_sampling_ = false;
+
+  // Undeformed geometry of each sampling setting used.
+  std::vector<std::unique_ptr<MeshData_t>> mesh_data_;
+  const MeshData_t *last_mesh_data_ = nullptr;
+
+  // Used to build the fill meshes.
+  Triangulator triangulator_;
+  std::vector<uint32_t> fill_indices_;
+
+  // Largest second difference of the glyph curves, used to select a level.
+  float max_curvature_ = 0.0f;
+
+  // Spatial queries acceleration structure.
+  mutable GlyphGrid grid_;
+  mutable std::once_flag grid_flag_;
 };
 
 /* -------------------------------------------------------------------------- */
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "ofxGlyphMesh.h"
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyphMesh::generate(
+  Settings_t const& settings,
+  ofxGlyph::updateVerticesFunc_t const& updateVertices,
+  Triangulator &triangulator
+)
+{
+  // Displace the sampled glyph paths and extract its mesh data for
+  // triangulation.
+  polygon.segments.assign(base->segments.begin(), base->segments.end());
+  polygon.holes.assign(base->holes.begin(), base->holes.end());
+  if (updateVertices) {
+    ofxGlyph::DisplaceMeshData(*base, polygon.points, updateVertices);
+  } else {
+    polygon.points.assign(base->vertices.begin(), base->vertices.end());
+  }
+
+  // Rebuild the connectivity only when the sampled counts change.
+  topology.update(
+    reinterpret_cast<const float*>(polygon.points.data()), 3, polygon.points.size(),
+    reinterpret_cast<const int*>(polygon.segments.data()), polygon.segments.size(),
+    settings.ear_clipping, triangulator
+  );
+
+  // Generate a tristrip for its extruded edge.
+  const float edge_width{ 1.0f }; //
+
+  edge_vertices.resize(2 * polygon.points.size());
+  for (size_t i = 0; i < polygon.points.size(); ++i) {
+    const auto &v = polygon.points[i];
+    edge_vertices[2*i + 0] = glm::vec3(v.x, v.y, v.z);
+    edge_vertices[2*i + 1] = glm::vec3(v.x, v.y, v.z - edge_width);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyphMesh::writeMeshes(Settings_t const& settings, bool merged, uint64_t revision)
+{
+  // The merged buffer reads the generated geometry directly.
+  source.face_vertices     = reinterpret_cast<const float*>(polygon.points.data());
+  source.num_face_vertices = static_cast<int>(polygon.points.size());
+  source.face_indices      = topology.getFaceIndices().data();
+  source.num_face_indices  = static_cast<int>(topology.getFaceIndices().size());
+  source.edge_vertices     = reinterpret_cast<const float*>(edge_vertices.data());
+  source.num_edge_vertices = static_cast<int>(edge_vertices.size());
+  source.edge_indices      = topology.getEdgeIndices().data();
+  source.num_edge_indices  = static_cast<int>(topology.getEdgeIndices().size());
+  source.stride            = 3;
+  source.topology          = topology.getVersion();
+  source.revision          = revision;
+
+  if (merged) {
+    return;
+  }
+
+  // Only rewrite the positions of the meshes whose topology is unchanged.
+  if (settings.ear_clipping) {
+    if (fill_version != topology.getVersion()) {
+      fill_version = topology.getVersion();
+      fill.clear();
+      fill.setMode(OF_PRIMITIVE_TRIANGLES);
+      fill.addVertices(polygon.points);
+      const auto &indices = topology.getFaceIndices();
+      fill.getIndices().assign(indices.begin(), indices.end());
+    } else {
+      std::copy(polygon.points.begin(), polygon.points.end(), fill.getVertices().begin());
+    }
+  }
+
+  if (edge_version != topology.getVersion()) {
+    edge_version = topology.getVersion();
+    edge.clear();
+    edge.setMode(OF_PRIMITIVE_TRIANGLES);
+    edge.addVertices(edge_vertices);
+    const auto &indices = topology.getEdgeIndices();
+    edge.getIndices().assign(indices.begin(), indices.end());
+  } else {
+    std::copy(edge_vertices.begin(), edge_vertices.end(), edge.getVertices().begin());
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void ofxGlyphMesh::triangulateFace(Settings_t const& settings, bool merged)
+{
+  if (merged || settings.ear_clipping) {
+    return;
+  }
+
+  // Steiner points are inserted depending on the outline, so the
+  // constrained Delaunay triangulation is always redone.
+  face.triangulateConstrainedDelaunay(polygon, 24, 620);
+  face.generateVoronoiDiagram();
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "fontsampler/mesh_topology.h"
+#include "fontsampler/text_mesh_builder.h"
+#include "fontsampler/triangulator.h"
+
+#include "ofMain.h"
+#include "ofxGlyph.h"
+#include "ofxTriangleMesh.h"
+
+/* -------------------------------------------------------------------------- */
+
+///
+/// ofxGlyphMesh holds the extruded 3d mesh of a glyph, as drawn by
+/// ofxFontRenderer.
+///
+struct ofxGlyphMesh {
+  /* Geometry generation settings. */
+  struct Settings_t {
+    int subsamples = 8;
+    bool ear_clipping = false;  // otherwise constrained Delaunay.
+
+    bool operator==(Settings_t const& other) const {
+      return (subsamples == other.subsamples) && (ear_clipping == other.ear_clipping);
+    }
+  };
+
+  ofxGlyph *glyph_ptr = nullptr;
+
+  // Undisplaced geometry of the glyph, looked up by the thread preparing
+  // the generation so the workers do not access the glyph.
+  const ofxGlyph::MeshData_t *base = nullptr;
+
+  // Index of the renderer update which last processed the glyph, and of the
+  // one which last generated it, 0 if none did yet.
+  uint64_t update_index = 0u;
+  uint64_t generated_index = 0u;
+
+  // Whether an occurrence of the glyph was in view when last drawn.
+  bool visible = true;
+
+  // Averaged generation and write costs in milliseconds, measured with
+  // cost_num_points sampled points, and the last generation one.
+  float generate_cost = 0.0f;
+  float write_cost = 0.0f;
+  size_t cost_num_points = 1u;
+  float last_generate_cost = 0.0f;
+
+  ofPath path;
+  ofxTriangleMesh face;
+  ofMesh fill;    // face triangulated by ear clipping.
+  ofMesh edge;
+
+  // Geometry generated by the workers, before being written to the meshes,
+  // its connectivity being kept while the sampled topology is unchanged.
+  ofxTriangleMesh::Polygon_t polygon;
+  std::vector<glm::vec3> edge_vertices;
+  MeshTopology topology;
+
+  // Topology versions the drawn meshes were built from.
+  uint32_t fill_version = 0u;
+  uint32_t edge_version = 0u;
+
+  // Geometry given to the merged string buffer.
+  TextMeshBuilder::Source_t source;
+
+  /* Displace and triangulate the base geometry into the geometry buffers.
+   * Safe to call concurrently for different glyph meshes.
+   * @param updateVertices : displacement functor, none when empty. */
+  void generate(
+    Settings_t const& settings,
+    ofxGlyph::updateVerticesFunc_t const& updateVertices,
+    Triangulator &triangulator
+  );
+
+  /* Write the geometry buffers to the ear clipped and edge meshes drawn,
+   * and describe them to the merged buffer with the given revision.
+   * Safe to call concurrently for different glyph meshes which are not
+   * drawn meanwhile. */
+  void writeMeshes(Settings_t const& settings, bool merged, uint64_t revision);
+
+  /* Triangulate the written face by constrained Delaunay, when the settings
+   * use it. ofxTriangleMesh wraps Triangle, whose robust predicates and
+   * random seed are process-wide globals, so it is not re-entrant and is
+   * only called from the application thread. */
+  void triangulateFace(Settings_t const& settings, bool merged);
+};
+
+/* -------------------------------------------------------------------------- */
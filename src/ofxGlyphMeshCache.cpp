@@ -0,0 +1,87 @@
+#include "ofxGlyphMeshCache.h"
+
+/* -------------------------------------------------------------------------- */
+
+std::shared_ptr<ofxGlyphMesh> ofxGlyphMeshCache::acquire(
+  uint16_t c,
+  ofxGlyphMesh::Settings_t const& settings
+)
+{
+  auto &table = getTable(settings);
+  auto &entry = (c < kNumFlatChars) ? table.flat[c] : table.others[c];
+
+  if (!entry) {
+    entry = std::make_shared<ofxGlyphMesh>();
+
+    if (auto *glyph = fontsampler_.get(c); glyph) {
+      entry->glyph_ptr = glyph;
+      glyph->extractPath(entry->path);
+      entry->base = &glyph->getMeshData(settings.subsamples, true);
+      entry->generate(settings, nullptr, triangulator_);
+      entry->writeMeshes(settings, false, 0u);
+      entry->triangulateFace(settings, false);
+    }
+  }
+  return entry;
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t ofxGlyphMeshCache::purge()
+{
+  size_t count = 0u;
+  auto unused = [](std::shared_ptr<ofxGlyphMesh> const& entry) {
+    return entry && (1 == entry.use_count());
+  };
+
+  for (auto &table : tables_) {
+    for (auto &entry : table->flat) {
+      if (unused(entry)) {
+        entry.reset();
+        ++count;
+      }
+    }
+    for (auto it = table->others.begin(); it != table->others.end();) {
+      if (unused(it->second)) {
+        it = table->others.erase(it);
+        ++count;
+      } else {
+        ++it;
+      }
+    }
+  }
+  return count;
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t ofxGlyphMeshCache::size() const
+{
+  size_t count = 0u;
+  for (const auto &table : tables_) {
+    for (const auto &entry : table->flat) {
+      count += entry ? 1u : 0u;
+    }
+    count += table->others.size();
+  }
+  return count;
+}
+
+/* -------------------------------------------------------------------------- */
+
+ofxGlyphMeshCache::Table_t& ofxGlyphMeshCache::getTable(
+  ofxGlyphMesh::Settings_t const& settings
+)
+{
+  for (auto &table : tables_) {
+    if (table->settings == settings) {
+      return *table;
+    }
+  }
+
+  tables_.push_back(std::make_unique<Table_t>());
+  tables_.back()->settings = settings;
+  return *tables_.back();
+}
+
+/* -------------------------------------------------------------------------- */
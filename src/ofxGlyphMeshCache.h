@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+#include "fontsampler/triangulator.h"
+
+#include "ofxFontSampler.h"
+#include "ofxGlyphMesh.h"
+
+/* -------------------------------------------------------------------------- */
+
+///
+/// ofxGlyphMeshCache shares the undisplaced meshes of a font glyphs between
+/// renderers, so static texts cost one mesh per distinct glyph and setting
+/// whatever their number of labels.
+/// Entries are reference counted, those only held by the cache being
+/// released by purge.
+///
+class ofxGlyphMeshCache {
+ public:
+  // Characters below this code are found in a flat array.
+  static constexpr int kNumFlatChars = 256;
+
+  explicit ofxGlyphMeshCache(ofxFontSampler &fontsampler)
+    : fontsampler_(fontsampler)
+  {}
+
+  /* Return the mesh of a character generated with the given settings, on
+   * first request. Its glyph is nullptr when the font has none. */
+  std::shared_ptr<ofxGlyphMesh> acquire(uint16_t c, ofxGlyphMesh::Settings_t const& settings);
+
+  /* Release the entries no renderer holds anymore.
+   * @return the number of entries released. */
+  size_t purge();
+
+  /* Number of cached entries. */
+  size_t size() const;
+
+ private:
+  struct Table_t {
+    ofxGlyphMesh::Settings_t settings;
+    std::array<std::shared_ptr<ofxGlyphMesh>, kNumFlatChars> flat;
+    std::unordered_map<uint16_t, std::shared_ptr<ofxGlyphMesh>> others;
+  };
+
+  /* Return the table of a setting, created on first use. */
+  Table_t& getTable(ofxGlyphMesh::Settings_t const& settings);
+
+  ofxFontSampler &fontsampler_;
+  std::vector<std::unique_ptr<Table_t>> tables_;
+  Triangulator triangulator_;
+};
+
+/* -------------------------------------------------------------------------- */
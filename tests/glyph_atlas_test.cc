@@ -0,0 +1,179 @@
+/* Headless check of the glyph atlas packing, built from the core library
+ * alone :
+ *
+ *   g++ -std=c++17 -O2 -pthread -Ilibs/fontsampler -o glyph_atlas_test \
+ *       tests/glyph_atlas_test.cc libs/fontsampler/[a-z]*.cc
+ *   ./glyph_atlas_test
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "glyph_atlas.h"
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+#define CHECK(cond) \
+  if (!(cond)) { \
+    fprintf(stderr, "Error : check failed line %d : %s\n", __LINE__, #cond); \
+    return false; \
+  }
+
+/* 64x64 single page holding 16 bitmaps of 15x15, padded to 16x16. */
+constexpr int kPageSize = 64;
+constexpr int kBitmapSize = 15;
+constexpr int kNumFitting = 16;
+
+/* Bitmap whose pixels identify its key. */
+std::vector<uint8_t> Bitmap(uint32_t key, int size = kBitmapSize) {
+  std::vector<uint8_t> pixels(size * size);
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<uint8_t>(key * 7u + i);
+  }
+  return pixels;
+}
+
+bool Insert(GlyphAtlas &atlas, uint32_t key, int size = kBitmapSize) {
+  const auto pixels = Bitmap(key, size);
+  return atlas.insert(key, size, size, pixels.data(), size);
+}
+
+/* Return true if the atlas holds the bitmap of key. */
+bool Holds(GlyphAtlas &atlas, uint32_t key, int size = kBitmapSize) {
+  const auto *region = atlas.find(key);
+  CHECK(nullptr != region);
+  CHECK((size == region->width) && (size == region->height));
+
+  const auto &page = atlas.getPage(region->page);
+  const auto pixels = Bitmap(key, size);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      CHECK(pixels[y * size + x] == page.pixels[(region->y + y) * page.width + region->x + x]);
+    }
+  }
+  return true;
+}
+
+bool Fill(GlyphAtlas &atlas, uint32_t first_key) {
+  for (uint32_t key = first_key; key < first_key + kNumFitting; ++key) {
+    CHECK(Insert(atlas, key));
+  }
+  CHECK(0 == atlas.getStats().num_evictions);
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool CheckInsert() {
+  GlyphAtlas atlas(kPageSize, kPageSize);
+  CHECK(Fill(atlas, 0u));
+  CHECK(1 == atlas.getNumPages());
+  CHECK(1.0f == atlas.getStats().occupancy);
+  for (uint32_t key = 0u; key < kNumFitting; ++key) {
+    CHECK(Holds(atlas, key));
+  }
+
+  // Too large for a page : rejected, the previous bitmap of the key is kept.
+  CHECK(!Insert(atlas, 3u, kPageSize));
+  CHECK(Holds(atlas, 3u));
+
+  // Replaced by a bitmap of another size.
+  CHECK(Insert(atlas, 3u, 8));
+  CHECK(Holds(atlas, 3u, 8));
+  return true;
+}
+
+bool CheckEvict() {
+  GlyphAtlas atlas(kPageSize, kPageSize);
+  CHECK(Fill(atlas, 0u));
+
+  // The first half was used last, so the second half is evicted first.
+  for (uint32_t key = 0u; key < kNumFitting / 2; ++key) {
+    CHECK(nullptr != atlas.find(key));
+  }
+  CHECK(Insert(atlas, 100u));
+  CHECK(atlas.getStats().num_evictions > 0);
+  CHECK(Holds(atlas, 100u));
+  for (uint32_t key = 0u; key < kNumFitting / 2; ++key) {
+    CHECK(Holds(atlas, key));
+  }
+  CHECK(!atlas.contains(kNumFitting / 2));
+  return true;
+}
+
+bool CheckRemoveAll() {
+  GlyphAtlas atlas(kPageSize, kPageSize);
+  CHECK(Fill(atlas, 0u));
+  for (uint32_t key = 0u; key < kNumFitting; ++key) {
+    atlas.remove(key);
+  }
+  CHECK(0 == atlas.getStats().num_entries);
+
+  // The removed area is reclaimed, a whole atlas fits again.
+  CHECK(Fill(atlas, 100u));
+  for (uint32_t key = 100u; key < 100u + kNumFitting; ++key) {
+    CHECK(Holds(atlas, key));
+  }
+  return true;
+}
+
+bool CheckRepack() {
+  GlyphAtlas atlas(kPageSize, kPageSize);
+  CHECK(Fill(atlas, 0u));
+
+  // Removed entries are reclaimed before any live one is evicted.
+  for (uint32_t key = 0u; key < kNumFitting; key += 2u) {
+    atlas.remove(key);
+  }
+  for (uint32_t key = 100u; key < 100u + kNumFitting / 2; ++key) {
+    CHECK(Insert(atlas, key));
+  }
+  CHECK(0 == atlas.getStats().num_evictions);
+  CHECK(atlas.getStats().num_repacks > 0);
+
+  // An explicit repack moves the bitmaps without altering them.
+  atlas.repack();
+  CHECK(kNumFitting == atlas.getStats().num_entries);
+  for (uint32_t key = 1u; key < kNumFitting; key += 2u) {
+    CHECK(Holds(atlas, key));
+  }
+  for (uint32_t key = 100u; key < 100u + kNumFitting / 2; ++key) {
+    CHECK(Holds(atlas, key));
+  }
+  return true;
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+int main() {
+  const struct {
+    const char *name;
+    bool (*check)();
+  } checks[] = {
+    { "insert",     CheckInsert },
+    { "evict",      CheckEvict },
+    { "remove all", CheckRemoveAll },
+    { "repack",     CheckRepack },
+  };
+
+  int num_failed = 0;
+  for (const auto &c : checks) {
+    if (!c.check()) {
+      fprintf(stderr, "Error : %s check failed.\n", c.name);
+      ++num_failed;
+    }
+  }
+
+  if (num_failed > 0) {
+    return EXIT_FAILURE;
+  }
+  fprintf(stderr, "glyph atlas : OK\n");
+  return EXIT_SUCCESS;
+}
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,284 @@
+/* Headless timings of the core library glyph processing, built without
+ * openFrameworks :
+ *
+ *   g++ -std=c++17 -O2 -pthread -Ilibs/fontsampler -o glyph_benchmark \
+ *       tests/glyph_benchmark.cc libs/fontsampler/[a-z]*.cc
+ *   ./glyph_benchmark example/bin/data/FreeSans.ttf
+ *
+ * It reports the rasterizer throughput, the ear clipping cost, the triangle
+ * counts of the curve-aware triangulation against the sampled paths, and the
+ * per frame generation of a long animated string on one thread and on the
+ * shared pool. The constrained Delaunay path and the ofMesh writes need the
+ * openFrameworks addons and are not covered.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "curve_triangulator.h"
+#include "glyph.h"
+#include "mesh_topology.h"
+#include "rasterizer.h"
+#include "simplex_noise.h"
+#include "thread_pool.h"
+#include "triangulator.h"
+#include "ttf_reader.h"
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+using Clock_t = std::chrono::steady_clock;
+
+double ElapsedSeconds(Clock_t::time_point start) {
+  return std::chrono::duration<double>(Clock_t::now() - start).count();
+}
+
+/* Printable ASCII characters. */
+std::u16string Charset() {
+  std::u16string charset;
+  for (char16_t c = 33; c < 127; ++c) {
+    charset.push_back(c);
+  }
+  return charset;
+}
+
+/* Sampled geometry of a glyph, with its normals for the displacement. */
+struct Sampling_t {
+  std::vector<float> xyz;
+  std::vector<float> normals;
+  std::vector<int> segments;
+
+  int num_points() const {
+    return static_cast<int>(xyz.size() / 3);
+  }
+
+  int num_segments() const {
+    return static_cast<int>(segments.size() / 2);
+  }
+};
+
+void Sample(const Glyph &glyph, int subsamples, Sampling_t &out) {
+  out.xyz.clear();
+  out.normals.clear();
+  out.segments.clear();
+
+  GlyphPath::Sampling_t sampling;
+  for (int i = 0; i < glyph.getNumPaths(); ++i) {
+    glyph.getPath(i)->sample(sampling, subsamples, true, true);
+    const int first = out.num_points();
+    const int count = sampling.size();
+    for (int j = 0; j < count; ++j) {
+      out.xyz.insert(out.xyz.end(), { sampling.vertices[j].x, sampling.vertices[j].y, 0.0f });
+      out.normals.insert(out.normals.end(), { sampling.normals[j].x, sampling.normals[j].y, 0.0f });
+      out.segments.push_back(first + j);
+      out.segments.push_back(first + (j + 1) % count);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void BenchRasterizer(TTFReader &reader) {
+  const auto charset = Charset();
+  constexpr int kIterations = 200;
+
+  Rasterizer rasterizer;
+  std::vector<uint8_t> bitmap;
+  for (float size : { 12.0f, 24.0f, 48.0f, 96.0f }) {
+    std::vector<std::unique_ptr<Glyph>> glyphs;
+    for (auto c : charset) {
+      if (auto *data = reader.get_glyph_data(c)) {
+        glyphs.emplace_back(new Glyph(*data, size, size));
+      }
+    }
+
+    const auto start = Clock_t::now();
+    for (int i = 0; i < kIterations; ++i) {
+      for (const auto &glyph : glyphs) {
+        const auto layout = Rasterizer::GetLayout(*glyph);
+        bitmap.resize(layout.width * layout.height);
+        rasterizer.rasterize(*glyph, layout, bitmap.data(), layout.width);
+      }
+    }
+    const double seconds = ElapsedSeconds(start);
+    printf("rasterizer %3.0f px : %9.0f glyphs/s\n", size, kIterations * glyphs.size() / seconds);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void BenchTriangulation(TTFReader &reader) {
+  const auto charset = Charset();
+  constexpr int kIterations = 20;
+
+  Triangulator triangulator;
+  CurveTriangulator curve_triangulator;
+  CurveTriangulator::Mesh_t curve_mesh;
+  std::vector<uint32_t> indices;
+  Sampling_t sampling;
+
+  long num_curve_triangles = 0;
+  for (auto c : charset) {
+    if (auto *data = reader.get_glyph_data(c)) {
+      const Glyph glyph(*data);
+      if (curve_triangulator.triangulate(glyph, curve_mesh)) {
+        num_curve_triangles += curve_mesh.getNumTriangles();
+      }
+    }
+  }
+  printf("curve-aware triangulation : %ld triangles\n", num_curve_triangles);
+
+  for (int subsamples : { 2, 4, 8 }) {
+    double seconds = 0.0;
+    long num_triangles = 0;
+    int num_glyphs = 0;
+    for (auto c : charset) {
+      auto *data = reader.get_glyph_data(c);
+      if (nullptr == data) {
+        continue;
+      }
+      const Glyph glyph(*data);
+      Sample(glyph, subsamples, sampling);
+
+      const auto start = Clock_t::now();
+      for (int i = 0; i < kIterations; ++i) {
+        triangulator.triangulate(
+          sampling.xyz.data(), 3, sampling.num_points(),
+          sampling.segments.data(), sampling.num_segments(),
+          indices
+        );
+      }
+      seconds += ElapsedSeconds(start) / kIterations;
+      num_triangles += indices.size() / 3;
+      ++num_glyphs;
+    }
+    printf("ear clipping, %d subsamples : %6.1f us/glyph, %ld triangles\n",
+      subsamples, 1.0e6 * seconds / num_glyphs, num_triangles
+    );
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Per frame generation of an animated string, as done by ofxFontRenderer :
+ * displacement, ear clipping when the topology changes and edge vertices. */
+class StringFrame {
+ public:
+  StringFrame(TTFReader &reader, const std::u16string &str, int subsamples) {
+    for (auto c : str) {
+      auto *data = reader.get_glyph_data(c);
+      if (nullptr == data) {
+        continue;
+      }
+      glyphs_.emplace_back();
+      auto &glyph = glyphs_.back();
+      Sample(Glyph(*data), subsamples, glyph.base);
+    }
+  }
+
+  int size() const {
+    return static_cast<int>(glyphs_.size());
+  }
+
+  /* Return the average time of a frame, after a first one building the
+   * topologies. */
+  double run(ThreadPool &pool, int num_frames) {
+    std::vector<Triangulator> triangulators(pool.getConcurrency());
+    SimplexNoise::Params_t params;
+    params.amplitude = 12.0f;
+    params.frequency = 0.01f;
+    params.bias = 1.0f;
+
+    auto start = Clock_t::now();
+    for (int frame = -1; frame < num_frames; ++frame) {
+      if (0 == frame) {
+        start = Clock_t::now();
+      }
+      params.time = 0.016f * frame;
+      pool.parallelFor(size(), 1, [&](int begin, int end, int participant) {
+        for (int i = begin; i < end; ++i) {
+          generate(glyphs_[i], params, triangulators[participant]);
+        }
+      });
+    }
+    return ElapsedSeconds(start) / num_frames;
+  }
+
+ private:
+  struct Glyph_t {
+    Sampling_t base;
+    std::vector<float> xyz;
+    std::vector<float> edge_vertices;
+    MeshTopology topology;
+  };
+
+  static void generate(Glyph_t &glyph, const SimplexNoise::Params_t &params, Triangulator &triangulator) {
+    const auto &base = glyph.base;
+    glyph.xyz = base.xyz;
+    SimplexNoise::Displace(glyph.xyz.data(), base.normals.data(), 3, base.num_points(), params);
+
+    glyph.topology.update(
+      glyph.xyz.data(), 3, base.num_points(),
+      base.segments.data(), base.num_segments(),
+      true, triangulator
+    );
+
+    glyph.edge_vertices.resize(6 * base.num_points());
+    for (int i = 0; i < base.num_points(); ++i) {
+      const float *v = &glyph.xyz[3*i];
+      float *e = &glyph.edge_vertices[6*i];
+      e[0] = v[0]; e[1] = v[1]; e[2] = v[2];
+      e[3] = v[0]; e[4] = v[1]; e[5] = v[2] - 1.0f;
+    }
+  }
+
+  std::vector<Glyph_t> glyphs_;
+};
+
+void BenchString(TTFReader &reader) {
+  constexpr int kFrames = 60;
+
+  std::u16string str;
+  for (int i = 0; i < 8; ++i) {
+    str += u"Sphinx of black quartz, judge my vow. 0123456789 ";
+  }
+
+  ThreadPool serial(0);
+  auto &shared = ThreadPool::Shared();
+  for (int subsamples : { 4, 8 }) {
+    StringFrame serial_frame(reader, str, subsamples);
+    StringFrame shared_frame(reader, str, subsamples);
+    const double serial_time = serial_frame.run(serial, kFrames);
+    const double shared_time = shared_frame.run(shared, kFrames);
+    printf("string of %d glyphs, %d subsamples : %.2f ms/frame on 1 thread, %.2f ms/frame on %d\n",
+      serial_frame.size(), subsamples, 1.0e3 * serial_time, 1.0e3 * shared_time, shared.getConcurrency()
+    );
+  }
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char *argv[]) {
+  const char *filename = (argc > 1) ? argv[1] : "example/bin/data/FreeSans.ttf";
+
+  TTFReader reader;
+  if (!reader.read(filename)) {
+    fprintf(stderr, "Error : can't read the font \"%s\".\n", filename);
+    return EXIT_FAILURE;
+  }
+
+  BenchRasterizer(reader);
+  BenchTriangulation(reader);
+  BenchString(reader);
+
+  return EXIT_SUCCESS;
+}
+
+/* -------------------------------------------------------------------------- */
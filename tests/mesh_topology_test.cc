@@ -0,0 +1,201 @@
+/* Headless check of the topology versioning of the glyph meshes, built from
+ * the core library alone :
+ *
+ *   g++ -std=c++17 -O2 -pthread -Ilibs/fontsampler -o mesh_topology_test \
+ *       tests/mesh_topology_test.cc libs/fontsampler/[a-z]*.cc
+ *   ./mesh_topology_test example/bin/data/FreeSans.ttf
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "glyph.h"
+#include "mesh_topology.h"
+#include "text_mesh_builder.h"
+#include "triangulator.h"
+#include "ttf_reader.h"
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+#define CHECK(cond) \
+  if (!(cond)) { \
+    fprintf(stderr, "Error : check failed line %d : %s\n", __LINE__, #cond); \
+    return false; \
+  }
+
+/* Sampled geometry of a glyph, its contours closed by their segments.
+ * Straight segments are sampled too so every sample count changes the
+ * topology. */
+struct Sampling_t {
+  std::vector<float> xyz;
+  std::vector<int> segments;
+
+  int num_points() const {
+    return static_cast<int>(xyz.size() / 3);
+  }
+
+  int num_segments() const {
+    return static_cast<int>(segments.size() / 2);
+  }
+};
+
+void Sample(const Glyph &glyph, int subsamples, Sampling_t &out) {
+  out.xyz.clear();
+  out.segments.clear();
+
+  GlyphPath::Sampling_t sampling;
+  for (int i = 0; i < glyph.getNumPaths(); ++i) {
+    glyph.getPath(i)->sample(sampling, subsamples, true);
+    const int first = out.num_points();
+    const int count = sampling.size();
+    for (int j = 0; j < count; ++j) {
+      out.xyz.insert(out.xyz.end(), { sampling.vertices[j].x, sampling.vertices[j].y, 0.0f });
+      out.segments.push_back(first + j);
+      out.segments.push_back(first + (j + 1) % count);
+    }
+  }
+}
+
+/* Displace the positions along z, as animated frames do. */
+void Displace(float time, Sampling_t &sampling) {
+  for (int i = 0; i < sampling.num_points(); ++i) {
+    sampling.xyz[3*i + 2] = time * (i % 7);
+  }
+}
+
+bool Update(MeshTopology &topology, const Sampling_t &sampling, Triangulator &triangulator) {
+  return topology.update(
+    sampling.xyz.data(), 3, sampling.num_points(),
+    sampling.segments.data(), sampling.num_segments(),
+    true, triangulator
+  );
+}
+
+/* Return true if the indices address the points of the sampling. */
+bool CheckIndices(const MeshTopology &topology, const Sampling_t &sampling) {
+  const auto &face = topology.getFaceIndices();
+  const auto &edge = topology.getEdgeIndices();
+  CHECK(!face.empty() && (0u == face.size() % 3u));
+  CHECK(edge.size() == 6u * sampling.num_segments());
+  for (auto index : face) {
+    CHECK(index < static_cast<uint32_t>(sampling.num_points()));
+  }
+  for (auto index : edge) {
+    CHECK(index < 2u * sampling.num_points());
+  }
+  return true;
+}
+
+/* Describe the sampled geometry of a glyph to the merged buffer. */
+void SetSource(const MeshTopology &topology, const Sampling_t &sampling, uint64_t revision, TextMeshBuilder::Source_t &source) {
+  source.face_vertices     = sampling.xyz.data();
+  source.num_face_vertices = sampling.num_points();
+  source.face_indices      = topology.getFaceIndices().data();
+  source.num_face_indices  = static_cast<int>(topology.getFaceIndices().size());
+  source.edge_vertices     = sampling.xyz.data();
+  source.num_edge_vertices = sampling.num_points();
+  source.edge_indices      = topology.getEdgeIndices().data();
+  source.num_edge_indices  = static_cast<int>(topology.getEdgeIndices().size());
+  source.stride            = 3;
+  source.topology          = topology.getVersion();
+  source.revision          = revision;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool CheckTopology(const Glyph &glyph) {
+  Triangulator triangulator;
+  MeshTopology topology;
+  TextMeshBuilder builder;
+  TextMeshBuilder::Source_t source;
+  TextMeshBuilder::Instance_t instance{ &source, { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0 } };
+  TextMeshBuilder::Params_t params;
+  Sampling_t sampling;
+
+  // First frame.
+  Sample(glyph, 4, sampling);
+  CHECK(Update(topology, sampling, triangulator));
+  CHECK(1u == topology.getVersion());
+  CHECK(CheckIndices(topology, sampling));
+  SetSource(topology, sampling, 1u, source);
+  CHECK(builder.build(&instance, 1, params).layout);
+
+  // Same sample count : only the positions move, the indices are kept.
+  const auto face = topology.getFaceIndices();
+  const auto edge = topology.getEdgeIndices();
+  const auto *face_data = topology.getFaceIndices().data();
+  const auto builder_indices = builder.getIndices();
+  for (int frame = 2; frame < 5; ++frame) {
+    Displace(0.1f * frame, sampling);
+    CHECK(!Update(topology, sampling, triangulator));
+    CHECK(1u == topology.getVersion());
+    CHECK(face == topology.getFaceIndices());
+    CHECK(face_data == topology.getFaceIndices().data());
+    CHECK(edge == topology.getEdgeIndices());
+
+    SetSource(topology, sampling, frame, source);
+    const auto changes = builder.build(&instance, 1, params);
+    CHECK(!changes.layout);
+    CHECK(changes.num_vertices > 0);
+    CHECK(builder_indices == builder.getIndices());
+  }
+
+  // Changed sample count : the version is bumped and the indices rebuilt.
+  Sample(glyph, 7, sampling);
+  CHECK(Update(topology, sampling, triangulator));
+  CHECK(2u == topology.getVersion());
+  CHECK(CheckIndices(topology, sampling));
+  CHECK(face.size() != topology.getFaceIndices().size());
+  CHECK(edge.size() != topology.getEdgeIndices().size());
+  SetSource(topology, sampling, 5u, source);
+  CHECK(builder.build(&instance, 1, params).layout);
+  CHECK(builder_indices.size() != builder.getIndices().size());
+
+  // Cleared : the next update rebuilds everything with a new version.
+  topology.clear();
+  CHECK(Update(topology, sampling, triangulator));
+  CHECK(3u == topology.getVersion());
+  CHECK(CheckIndices(topology, sampling));
+
+  return true;
+}
+
+} // namespace ""
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char *argv[]) {
+  const char *filename = (argc > 1) ? argv[1] : "example/bin/data/FreeSans.ttf";
+
+  TTFReader reader;
+  if (!reader.read(filename)) {
+    fprintf(stderr, "Error : can't read the font \"%s\".\n", filename);
+    return EXIT_FAILURE;
+  }
+
+  // One contour, a hole, two holes.
+  int num_failed = 0;
+  for (uint16_t c : { u'S', u'A', u'B' }) {
+    const auto *data = reader.get_glyph_data(c);
+    if (nullptr == data) {
+      fprintf(stderr, "Error : missing glyph '%c'.\n", c);
+      return EXIT_FAILURE;
+    }
+    const Glyph glyph(*data);
+    if (!CheckTopology(glyph)) {
+      fprintf(stderr, "Error : topology check failed for '%c'.\n", c);
+      ++num_failed;
+    }
+  }
+
+  if (num_failed > 0) {
+    return EXIT_FAILURE;
+  }
+  fprintf(stderr, "mesh topology : OK\n");
+  return EXIT_SUCCESS;
+}
+
+/* -------------------------------------------------------------------------- */